@@ -26,22 +26,31 @@
 # originally generated with the command:
 # find opm -name '*.c*' -printf '\t%p\n' | sort
 list (APPEND MAIN_SOURCE_FILES
+	opm/polymer/BackgroundTaskQueue.cpp
 	opm/polymer/CompressibleTpfaPolymer.cpp
 	opm/polymer/IncompTpfaPolymer.cpp
+	opm/polymer/InexactNewtonLinearSolver.cpp
+	opm/polymer/IncrementalLinearSolver.cpp
 	opm/polymer/PolymerInflow.cpp
 	opm/polymer/PolymerProperties.cpp
 	opm/polymer/polymerUtilities.cpp
+	opm/polymer/SequentialStepControl.cpp
 	opm/polymer/SimulatorCompressiblePolymer.cpp
 	opm/polymer/SimulatorPolymer.cpp
 	opm/polymer/TransportSolverTwophaseCompressiblePolymer.cpp
 	opm/polymer/TransportSolverTwophasePolymer.cpp
     opm/polymer/fullyimplicit/PolymerPropsAd.cpp
     opm/polymer/fullyimplicit/FullyImplicitCompressiblePolymerSolver.cpp
+    opm/polymer/fullyimplicit/LocalizedNewton.cpp
+    opm/polymer/fullyimplicit/NewtonIterationPolymerCPR.cpp
+    opm/polymer/fullyimplicit/NewtonIterationPolymerTransport.cpp
+    opm/polymer/fullyimplicit/PolymerFrontChange.cpp
 	)
 
 # originally generated with the command:
 # find tests -name '*.cpp' -a ! -wholename '*/not-unit/*' -printf '\t%p\n' | sort
 list (APPEND TEST_SOURCE_FILES
+	tests/test_polymerinflowschedule.cpp
 	)
 
 # originally generated with the command:
@@ -71,15 +80,19 @@ list (APPEND PROGRAM_SOURCE_FILES
 # originally generated with the command:
 # find opm -name '*.h*' -a ! -name '*-pch.hpp' -printf '\t%p\n' | sort
 list (APPEND PUBLIC_HEADER_FILES
+	opm/polymer/BackgroundTaskQueue.hpp
 	opm/polymer/CompressibleTpfaPolymer.hpp
 	opm/polymer/GravityColumnSolverPolymer.hpp
 	opm/polymer/GravityColumnSolverPolymer_impl.hpp
 	opm/polymer/IncompPropertiesDefaultPolymer.hpp
 	opm/polymer/IncompTpfaPolymer.hpp
+	opm/polymer/InexactNewtonLinearSolver.hpp
+	opm/polymer/IncrementalLinearSolver.hpp
 	opm/polymer/PolymerBlackoilState.hpp
 	opm/polymer/PolymerInflow.hpp
 	opm/polymer/PolymerProperties.hpp
 	opm/polymer/PolymerState.hpp
+	opm/polymer/SequentialStepControl.hpp
 	opm/polymer/polymerUtilities.hpp
 	opm/polymer/SimulatorCompressiblePolymer.hpp
 	opm/polymer/SimulatorPolymer.hpp
@@ -89,6 +102,11 @@ list (APPEND PUBLIC_HEADER_FILES
     opm/polymer/TransportSolverTwophasePolymer.hpp
     opm/polymer/fullyimplicit/PolymerPropsAd.hpp
     opm/polymer/fullyimplicit/FullyImplicitCompressiblePolymerSolver.hpp
+    opm/polymer/fullyimplicit/FusedAdElementwise.hpp
+    opm/polymer/fullyimplicit/LocalizedNewton.hpp
+    opm/polymer/fullyimplicit/NewtonIterationPolymerCPR.hpp
+    opm/polymer/fullyimplicit/NewtonIterationPolymerTransport.hpp
+    opm/polymer/fullyimplicit/PolymerFrontChange.hpp
     opm/polymer/fullyimplicit/SimulatorFullyImplicitCompressiblePolymer.hpp
     opm/polymer/fullyimplicit/SimulatorFullyImplicitCompressiblePolymer_impl.hpp
     opm/polymer/fullyimplicit/BlackoilPolymerModel.hpp
@@ -42,6 +42,7 @@
 #include <opm/core/linalg/LinearSolverFactory.hpp>
 #include <opm/autodiff/NewtonIterationBlackoilSimple.hpp>
 #include <opm/autodiff/NewtonIterationBlackoilCPR.hpp>
+#include <opm/polymer/fullyimplicit/NewtonIterationPolymerCPR.hpp>
 
 #include <opm/polymer/PolymerBlackoilState.hpp>
 #include <opm/autodiff/WellStateFullyImplicitBlackoil.hpp>
@@ -254,7 +255,9 @@ try
 
     // Solver for Newton iterations.
     std::unique_ptr<NewtonIterationBlackoilInterface> fis_solver;
-    if (param.getDefault("use_cpr", true)) {
+    if (param.getDefault("use_polymer_cpr", false)) {
+        fis_solver.reset(new NewtonIterationPolymerCPR(param, polymer));
+    } else if (param.getDefault("use_cpr", true)) {
         fis_solver.reset(new NewtonIterationBlackoilCPR(param));
     } else {
         fis_solver.reset(new NewtonIterationBlackoilSimple(param));
@@ -56,6 +56,7 @@
 
 #include <algorithm>
 #include <iostream>
+#include <string>
 #include <vector>
 #include <numeric>
 
@@ -258,6 +259,18 @@ try
                         "You seem to be trying to control it via parameter poly_start_days (etc.) as well.");
             }
         }
+        // Polymer injection of all report steps: from a table of
+        // concentrations over time if given, otherwise from WPOLYMER.
+        boost::scoped_ptr<PolymerInflowSchedule> polymer_schedule;
+        const std::string poly_schedule_file = param.getDefault("poly_schedule_file", std::string(""));
+        if (!poly_schedule_file.empty()) {
+            const bool linear = param.getDefault("poly_schedule_linear", true);
+            polymer_schedule.reset(new PolymerInflowSchedule(poly_schedule_file,
+                                                             linear ? PolymerInflowSchedule::Linear
+                                                                    : PolymerInflowSchedule::Stepwise));
+        } else if (use_wpolymer) {
+            polymer_schedule.reset(new PolymerInflowSchedule(eclipseState));
+        }
         for (size_t reportStepIdx = 0; reportStepIdx < timeMap->numTimesteps(); ++reportStepIdx) {
             simtimer.setCurrentStepNum(reportStepIdx);
 
@@ -269,11 +282,11 @@ try
             // Create new wells, polymer inflow controls.
             WellsManager wells(eclipseState , reportStepIdx , *grid->c_grid(), props->permeability());
             boost::scoped_ptr<PolymerInflowInterface> polymer_inflow;
-            if (use_wpolymer) {
+            if (polymer_schedule) {
                 if (wells.c_wells() == 0) {
                     OPM_THROW(std::runtime_error, "Cannot control polymer injection via WPOLYMER without wells.");
                 }
-                polymer_inflow.reset(new PolymerInflowFromDeck(deck, eclipseState, *wells.c_wells(), props->numCells(), simtimer.currentStepNum()));
+                polymer_inflow.reset(new PolymerInflowFromSchedule(*polymer_schedule, *wells.c_wells(), props->numCells()));
             } else {
                 polymer_inflow.reset(new PolymerInflowBasic(param.getDefault("poly_start_days", 300.0)*Opm::unit::day,
                                                             param.getDefault("poly_end_days", 800.0)*Opm::unit::day,
@@ -44,6 +44,7 @@
 #include <opm/polymer/PolymerState.hpp>
 #include <opm/core/simulator/WellState.hpp>
 #include <opm/polymer/SimulatorPolymer.hpp>
+#include <opm/polymer/BackgroundTaskQueue.hpp>
 #include <opm/polymer/PolymerInflow.hpp>
 #include <opm/polymer/PolymerProperties.hpp>
 
@@ -56,6 +57,7 @@
 
 #include <algorithm>
 #include <iostream>
+#include <string>
 #include <vector>
 #include <numeric>
 
@@ -295,6 +297,24 @@ try
                         "You seem to be trying to control it via parameter poly_start_days (etc.) as well.");
             }
         }
+        // Polymer injection of all report steps: from a table of
+        // concentrations over time if given, otherwise from WPOLYMER.
+        boost::scoped_ptr<PolymerInflowSchedule> polymer_schedule;
+        const std::string poly_schedule_file = param.getDefault("poly_schedule_file", std::string(""));
+        if (!poly_schedule_file.empty()) {
+            const bool linear = param.getDefault("poly_schedule_linear", true);
+            polymer_schedule.reset(new PolymerInflowSchedule(poly_schedule_file,
+                                                             linear ? PolymerInflowSchedule::Linear
+                                                                    : PolymerInflowSchedule::Stepwise));
+        } else if (use_wpolymer) {
+            polymer_schedule.reset(new PolymerInflowSchedule(eclipseState));
+        }
+        // With asynchronous output, one output thread serves all report
+        // steps, so that writing a step overlaps with simulating the next.
+        boost::scoped_ptr<BackgroundTaskQueue> output_queue;
+        if (param.getDefault("output_async", false)) {
+            output_queue.reset(new BackgroundTaskQueue(param.getDefault("output_queue_size", 2)));
+        }
         for (size_t reportStepIdx = 0; reportStepIdx < timeMap->numTimesteps(); ++reportStepIdx) {
             simtimer.setCurrentStepNum(reportStepIdx);
 
@@ -306,11 +326,11 @@ try
             // Create new wells, polymer inflow controls.
             WellsManager wells(eclipseState , reportStepIdx , *grid->c_grid(), props->permeability());
             boost::scoped_ptr<PolymerInflowInterface> polymer_inflow;
-            if (use_wpolymer) {
+            if (polymer_schedule) {
                 if (wells.c_wells() == 0) {
                     OPM_THROW(std::runtime_error, "Cannot control polymer injection via WPOLYMER without wells.");
                 }
-                polymer_inflow.reset(new PolymerInflowFromDeck(deck, eclipseState, *wells.c_wells(), props->numCells(), simtimer.currentStepNum()));
+                polymer_inflow.reset(new PolymerInflowFromSchedule(*polymer_schedule, *wells.c_wells(), props->numCells()));
             } else {
                 polymer_inflow.reset(new PolymerInflowBasic(param.getDefault("poly_start_days", 300.0)*Opm::unit::day,
                                                             param.getDefault("poly_end_days", 800.0)*Opm::unit::day,
@@ -335,7 +355,8 @@ try
                                        src,
                                        bcs.c_bcs(),
                                        linsolver,
-                                       grav);
+                                       grav,
+                                       output_queue.get());
             if (reportStepIdx == 0) {
                 warnIfUnusedParams(param);
             }
@@ -345,6 +366,10 @@ try
             rep += epoch_rep;
             step = simtimer.currentStepNum();
         }
+        if (output_queue) {
+            output_queue->wait();
+            output_queue->printMessages(std::cout);
+        }
     }
 
     std::cout << "\n\n================    End of simulation     ===============\n\n";
@@ -51,6 +51,7 @@
 #include <opm/core/simulator/WellState.hpp>
 
 #include <opm/polymer/fullyimplicit/SimulatorFullyImplicitCompressiblePolymer.hpp>
+#include <opm/polymer/fullyimplicit/NewtonIterationPolymerCPR.hpp>
 #include <opm/polymer/fullyimplicit/PolymerPropsAd.hpp>
 #include <opm/polymer/PolymerProperties.hpp>
 #include <opm/polymer/PolymerInflow.hpp>
@@ -209,7 +210,9 @@ try
     const double *grav = use_gravity ? &gravity[0] : 0;
     // Solver for Newton iterations.
     std::unique_ptr<NewtonIterationBlackoilInterface> fis_solver;
-    if (param.getDefault("use_cpr", true)) {
+    if (param.getDefault("use_polymer_cpr", false)) {
+        fis_solver.reset(new NewtonIterationPolymerCPR(param, true));
+    } else if (param.getDefault("use_cpr", true)) {
         fis_solver.reset(new NewtonIterationBlackoilCPR(param));
     } else {
         fis_solver.reset(new NewtonIterationBlackoilSimple(param));
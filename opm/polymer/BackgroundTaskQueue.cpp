@@ -0,0 +1,162 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <config.h>
+
+#include <opm/polymer/BackgroundTaskQueue.hpp>
+
+#include <algorithm>
+#include <iostream>
+#include <utility>
+
+namespace Opm
+{
+
+
+    BackgroundTaskQueue::BackgroundTaskQueue(const int max_queued)
+        : max_queued_(std::max(max_queued, 1)),
+          busy_(false),
+          stop_(false)
+    {
+        worker_ = std::thread(&BackgroundTaskQueue::run, this);
+    }
+
+
+
+
+    BackgroundTaskQueue::~BackgroundTaskQueue()
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        changed_.notify_all();
+        worker_.join();
+        printMessages(std::cout);
+        // A destructor must not throw, but a failed task must not go
+        // unnoticed either. Owners should wait() before destruction.
+        if (error_) {
+            try {
+                std::rethrow_exception(error_);
+            }
+            catch (const std::exception& e) {
+                std::cerr << "Background task failed, error not handled: " << e.what() << std::endl;
+            }
+            catch (...) {
+                std::cerr << "Background task failed, error not handled." << std::endl;
+            }
+        }
+    }
+
+
+
+
+    void BackgroundTaskQueue::push(Task task)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        changed_.wait(lock, [this]() { return tasks_.size() < max_queued_ || error_; });
+        rethrow();
+        tasks_.push_back(std::move(task));
+        lock.unlock();
+        changed_.notify_all();
+    }
+
+
+
+
+    void BackgroundTaskQueue::wait()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        changed_.wait(lock, [this]() { return (tasks_.empty() && !busy_) || error_; });
+        rethrow();
+    }
+
+
+
+
+    void BackgroundTaskQueue::post(std::string message)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        messages_.push_back(std::move(message));
+    }
+
+
+
+
+    void BackgroundTaskQueue::printMessages(std::ostream& os)
+    {
+        std::vector<std::string> messages;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            messages.swap(messages_);
+        }
+        for (std::size_t i = 0; i < messages.size(); ++i) {
+            os << messages[i];
+        }
+        os.flush();
+    }
+
+
+
+
+    void BackgroundTaskQueue::run()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;) {
+            changed_.wait(lock, [this]() { return !tasks_.empty() || stop_; });
+            if (tasks_.empty()) {
+                // Stopped, and all work is done.
+                return;
+            }
+            Task task = std::move(tasks_.front());
+            tasks_.pop_front();
+            busy_ = true;
+            lock.unlock();
+            changed_.notify_all();
+            try {
+                task();
+            }
+            catch (...) {
+                lock.lock();
+                if (!error_) {
+                    error_ = std::current_exception();
+                }
+                lock.unlock();
+            }
+            lock.lock();
+            busy_ = false;
+            changed_.notify_all();
+        }
+    }
+
+
+
+
+    // Must be called with the mutex held.
+    void BackgroundTaskQueue::rethrow()
+    {
+        if (error_) {
+            std::exception_ptr error = error_;
+            error_ = std::exception_ptr();
+            std::rethrow_exception(error);
+        }
+    }
+
+
+} // namespace Opm
@@ -0,0 +1,95 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_BACKGROUNDTASKQUEUE_HEADER_INCLUDED
+#define OPM_BACKGROUNDTASKQUEUE_HEADER_INCLUDED
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <iosfwd>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Opm
+{
+
+    /// A single worker thread executing tasks in submission order.
+    ///
+    /// Intended for output that can be written from a snapshot while
+    /// the simulation proceeds. The queue is bounded: push() blocks
+    /// while the given number of tasks is waiting, so a slow writer
+    /// throttles the simulator instead of accumulating snapshots.
+    /// An exception thrown by a task is rethrown by the next call to
+    /// push() or wait().
+    ///
+    /// Tasks must not write to shared streams such as std::cout, which
+    /// the simulation thread uses at the same time. They post their
+    /// text instead, and the thread owning the queue prints it.
+    class BackgroundTaskQueue
+    {
+    public:
+        typedef std::function<void()> Task;
+
+        /// Start the worker thread.
+        /// \param[in] max_queued  number of tasks allowed to wait, at least one.
+        explicit BackgroundTaskQueue(const int max_queued);
+
+        /// Finish all queued tasks and stop the worker thread. Text
+        /// not yet printed goes to std::cout, and an error not yet
+        /// rethrown is reported on std::cerr.
+        ~BackgroundTaskQueue();
+
+        /// Queue a task, blocking while the queue is full.
+        void push(Task task);
+
+        /// Block until all queued tasks have been executed.
+        void wait();
+
+        /// Store text for the owning thread, called by tasks.
+        void post(std::string message);
+
+        /// Write the text posted so far to a stream, in posting order,
+        /// and forget it. Called by the owning thread.
+        void printMessages(std::ostream& os);
+
+    private:
+        BackgroundTaskQueue(const BackgroundTaskQueue&);
+        BackgroundTaskQueue& operator=(const BackgroundTaskQueue&);
+
+        void run();
+        void rethrow();
+
+        const std::size_t max_queued_;
+        std::deque<Task> tasks_;
+        bool busy_;
+        bool stop_;
+        std::exception_ptr error_;
+        std::vector<std::string> messages_;
+        std::mutex mutex_;
+        std::condition_variable changed_;
+        std::thread worker_;
+    };
+
+} // namespace Opm
+
+#endif // OPM_BACKGROUNDTASKQUEUE_HEADER_INCLUDED
@@ -103,9 +103,11 @@ namespace Opm
         const int nc = grid_.number_of_cells;
         const int np = props_.numPhases();
         cell_relperm_.resize(nc*np);
-        cell_eff_viscosity_.resize(nc*np);
-        const double* cell_s = &state.saturation()[0];
-        props_.relperm(nc, cell_s, &allcells_[0], &cell_relperm_[0], 0);
+        if (state.saturation() != relperm_s_) {
+            const double* cell_s = &state.saturation()[0];
+            props_.relperm(nc, cell_s, &allcells_[0], &cell_relperm_[0], 0);
+            relperm_s_ = state.saturation();
+        }
         computeWellPotentials(state);
         if (rock_comp_props_ && rock_comp_props_->isActive()) {
             computePorevolume(grid_, props_.porosity(), *rock_comp_props_, state.pressure(), initial_porevol_);
@@ -123,7 +125,6 @@ namespace Opm
         // std::vector<double> cell_A_;
         // std::vector<double> cell_dA_;
         // std::vector<double> cell_viscosity_;
-        // std::vector<double> cell_eff_viscosity_;
         // std::vector<double> cell_phasemob_;
         // std::vector<double> cell_voldisc_;
         // std::vector<double> porevol_;   // Only modified if rock_comp_props_ is non-null.
@@ -140,7 +141,6 @@ namespace Opm
         props_.viscosity(nc, cell_p, cell_T, cell_z, &allcells_[0], &cell_viscosity_[0], 0);
         cell_phasemob_.resize(nc*np);
         for (int cell = 0; cell < nc; ++cell) {
-            poly_props_.effectiveVisc((*c_)[cell], &cell_viscosity_[np*cell + 0], cell_eff_viscosity_[np*cell + 0]);
             poly_props_.effectiveMobilities((*c_)[cell], (*cmax_)[cell], &cell_viscosity_[np*cell + 0], &cell_relperm_[np*cell + 0], &cell_phasemob_[np*cell + 0]);
         }
 
@@ -102,8 +102,10 @@ namespace Opm
         // ------ Data that will be updated every solve() call. ------
         const std::vector<double>* c_;
         const std::vector<double>* cmax_;
-        std::vector<double> cell_eff_viscosity_;
         std::vector<double> cell_relperm_;
+        // Saturation used for cell_relperm_, repeated solves with the same
+        // saturation (as in the well control loop) reuse the relperms.
+        std::vector<double> relperm_s_;
     };
 
 } // namespace Opm
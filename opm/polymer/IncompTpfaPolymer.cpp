@@ -132,23 +132,32 @@ namespace Opm
         // The only difference from IncompTpfa::computePerSolveDynamicData() is that
         // we call the polymer-aware versions of the computeTotalMobility*() functions.
 
-        // wdp_
-        if (wells_) {
-            Opm::computeWDP(*wells_, grid_, state.saturation(), props_.density(),
-                            gravity_ ? gravity_[2] : 0.0, true, wdp_);
+        // Mobility dependent data only change with saturation and
+        // concentration, skip them if those are as in the last solve.
+        const bool mobility_unchanged = state.saturation() == mob_s_
+            && *c_ == mob_c_ && *cmax_ == mob_cmax_;
+        if (!mobility_unchanged) {
+            // wdp_
+            if (wells_) {
+                Opm::computeWDP(*wells_, grid_, state.saturation(), props_.density(),
+                                gravity_ ? gravity_[2] : 0.0, true, wdp_);
+            }
+            // totmob_, omega_, gpress_omegaweighted_
+            if (gravity_) {
+                computeTotalMobilityOmega(props_, poly_props_, allcells_, state.saturation(), *c_, *cmax_,
+                                          totmob_, omega_);
+                mim_ip_density_update(grid_.number_of_cells, grid_.cell_facepos,
+                                      &omega_[0],
+                                      &gpress_[0], &gpress_omegaweighted_[0]);
+            } else {
+                computeTotalMobility(props_, poly_props_, allcells_, state.saturation(), *c_, *cmax_, totmob_);
+            }
+            // trans_
+            tpfa_eff_trans_compute(const_cast<UnstructuredGrid*>(&grid_), &totmob_[0], &htrans_[0], &trans_[0]);
+            mob_s_ = state.saturation();
+            mob_c_ = *c_;
+            mob_cmax_ = *cmax_;
         }
-        // totmob_, omega_, gpress_omegaweighted_
-        if (gravity_) {
-            computeTotalMobilityOmega(props_, poly_props_, allcells_, state.saturation(), *c_, *cmax_,
-                                      totmob_, omega_);
-            mim_ip_density_update(grid_.number_of_cells, grid_.cell_facepos,
-                                  &omega_[0],
-                                  &gpress_[0], &gpress_omegaweighted_[0]);
-        } else {
-            computeTotalMobility(props_, poly_props_, allcells_, state.saturation(), *c_, *cmax_, totmob_);
-        }
-        // trans_
-        tpfa_eff_trans_compute(const_cast<UnstructuredGrid*>(&grid_), &totmob_[0], &htrans_[0], &trans_[0]);
         // initial_porevol_
         if (rock_comp_props_ && rock_comp_props_->isActive()) {
             computePorevolume(grid_, props_.porosity(), *rock_comp_props_, state.pressure(), initial_porevol_);
@@ -104,6 +104,13 @@ namespace Opm
         // ------ Data that will be updated every solve() call. ------
         const std::vector<double>* c_;
         const std::vector<double>* cmax_;
+        // ------ Data kept between solve() calls. ------
+        // State used for the last mobility computation. Repeated solves
+        // with unchanged saturation and concentration (as in the well
+        // control loop) reuse the mobilities and transmissibilities.
+        std::vector<double> mob_s_;
+        std::vector<double> mob_c_;
+        std::vector<double> mob_cmax_;
     };
 
 } // namespace Opm
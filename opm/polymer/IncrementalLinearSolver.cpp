@@ -0,0 +1,444 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <config.h>
+
+#include <opm/polymer/IncrementalLinearSolver.hpp>
+
+#include <Eigen/Sparse>
+#include <Eigen/SparseLU>
+
+#include <algorithm>
+#include <cmath>
+
+namespace Opm
+{
+
+
+    struct IncrementalLinearSolver::ReservoirFactor
+    {
+        typedef Eigen::SparseMatrix<double> Matrix;
+        Matrix matrix;
+        Eigen::SparseLU<Matrix, Eigen::COLAMDOrdering<int> > lu;
+        bool analyzed = false;
+    };
+
+
+    namespace
+    {
+        /// Solve the dense system a x = b in place by Gaussian elimination
+        /// with partial pivoting. The matrix a is row major and is
+        /// overwritten, on return b contains the solution.
+        /// \return false if the matrix is (numerically) singular.
+        bool denseSolve(const int n, std::vector<double>& a, std::vector<double>& b)
+        {
+            for (int col = 0; col < n; ++col) {
+                int piv = col;
+                for (int row = col + 1; row < n; ++row) {
+                    if (std::fabs(a[row*n + col]) > std::fabs(a[piv*n + col])) {
+                        piv = row;
+                    }
+                }
+                if (a[piv*n + col] == 0.0) {
+                    return false;
+                }
+                if (piv != col) {
+                    std::swap_ranges(a.begin() + piv*n, a.begin() + (piv + 1)*n, a.begin() + col*n);
+                    std::swap(b[piv], b[col]);
+                }
+                for (int row = col + 1; row < n; ++row) {
+                    const double f = a[row*n + col]/a[col*n + col];
+                    if (f != 0.0) {
+                        for (int k = col; k < n; ++k) {
+                            a[row*n + k] -= f*a[col*n + k];
+                        }
+                        b[row] -= f*b[col];
+                    }
+                }
+            }
+            for (int row = n - 1; row >= 0; --row) {
+                double r = b[row];
+                for (int k = row + 1; k < n; ++k) {
+                    r -= a[row*n + k]*b[k];
+                }
+                b[row] = r/a[row*n + row];
+            }
+            return true;
+        }
+    } // anonymous namespace
+
+
+    IncrementalLinearSolver::IncrementalLinearSolver(LinearSolverInterface& linsolver)
+        : linsolver_(linsolver),
+          warm_start_(true),
+          num_reservoir_(0),
+          max_schur_wells_(0),
+          schur_valid_(false),
+          schur_rejected_(false),
+          num_solves_(0),
+          num_skipped_(0),
+          num_schur_(0)
+    {
+    }
+
+
+
+
+    IncrementalLinearSolver::~IncrementalLinearSolver()
+    {
+    }
+
+
+
+
+    LinearSolverInterface::LinearSolverReport
+    IncrementalLinearSolver::solve(const int size,
+                                   const int nonzeros,
+                                   const int* ia,
+                                   const int* ja,
+                                   const double* sa,
+                                   const double* rhs,
+                                   double* solution,
+                                   const boost::any& comm) const
+    {
+        ++num_solves_;
+        const double tol = linsolver_.getTolerance();
+        const bool same_pattern = comm.empty() && !x_prev_.empty()
+            && samePattern(size, nonzeros, ia, ja);
+
+        // Only the well rows changed: re-solve through the Schur complement.
+        if (num_reservoir_ > 0 && size > num_reservoir_
+            && size - num_reservoir_ <= max_schur_wells_) {
+            if (same_pattern && sameReservoirRows(sa, rhs)) {
+                LinearSolverReport rpt;
+                const SchurResult result = schur_rejected_ ? SchurFailed
+                    : solveWellSchur(size, ia, ja, sa, rhs, solution, rpt);
+                if (result == SchurSolved) {
+                    ++num_schur_;
+                    store(size, nonzeros, ia, ja, sa, rhs, solution);
+                    return rpt;
+                }
+                if (result == SchurInaccurate) {
+                    // Start the full solve from the Schur solution.
+                    store(size, nonzeros, ia, ja, sa, rhs, solution);
+                }
+            } else {
+                schur_valid_ = false;
+                schur_rejected_ = false;
+            }
+        }
+
+        if (!warm_start_ || tol <= 0.0 || !same_pattern) {
+            LinearSolverReport rpt = linsolver_.solve(size, nonzeros, ia, ja, sa, rhs, solution, comm);
+            if (comm.empty()) {
+                store(size, nonzeros, ia, ja, sa, rhs, solution);
+            }
+            return rpt;
+        }
+
+        // Residual of the previous solution, r = b - A x_prev.
+        residual_.resize(size);
+        double rhs_norm = 0.0;
+        double res_norm = 0.0;
+        for (int row = 0; row < size; ++row) {
+            double r = rhs[row];
+            for (int k = ia[row]; k < ia[row + 1]; ++k) {
+                r -= sa[k]*x_prev_[ja[k]];
+            }
+            residual_[row] = r;
+            rhs_norm += rhs[row]*rhs[row];
+            res_norm += r*r;
+        }
+        rhs_norm = std::sqrt(rhs_norm);
+        res_norm = std::sqrt(res_norm);
+
+        LinearSolverReport rpt;
+        if (res_norm <= tol*rhs_norm) {
+            // The previous solution is good enough.
+            std::copy(x_prev_.begin(), x_prev_.end(), solution);
+            rpt.converged = true;
+            rpt.iterations = 0;
+            rpt.residual_reduction = (rhs_norm > 0.0) ? res_norm/rhs_norm : 0.0;
+            ++num_skipped_;
+            store(size, nonzeros, ia, ja, sa, rhs, solution);
+            return rpt;
+        }
+
+        // Solve for the correction, asking for the reduction that
+        // brings the residual down to tol*|b|.
+        correction_.assign(size, 0.0);
+        linsolver_.setTolerance(tol*rhs_norm/res_norm);
+        try {
+            rpt = linsolver_.solve(size, nonzeros, ia, ja, sa, &residual_[0], &correction_[0], comm);
+        }
+        catch (...) {
+            linsolver_.setTolerance(tol);
+            throw;
+        }
+        linsolver_.setTolerance(tol);
+        for (int row = 0; row < size; ++row) {
+            solution[row] = x_prev_[row] + correction_[row];
+        }
+        rpt.residual_reduction *= res_norm/rhs_norm;
+        store(size, nonzeros, ia, ja, sa, rhs, solution);
+        return rpt;
+    }
+
+
+
+
+    void IncrementalLinearSolver::setTolerance(const double tol)
+    {
+        linsolver_.setTolerance(tol);
+    }
+
+
+
+
+    double IncrementalLinearSolver::getTolerance() const
+    {
+        return linsolver_.getTolerance();
+    }
+
+
+
+
+    void IncrementalLinearSolver::setWarmStart(const bool warm_start)
+    {
+        warm_start_ = warm_start;
+    }
+
+
+
+
+    void IncrementalLinearSolver::setWellSchurComplement(const int num_reservoir_unknowns,
+                                                         const int max_wells)
+    {
+        num_reservoir_ = num_reservoir_unknowns;
+        max_schur_wells_ = max_wells;
+        schur_valid_ = false;
+        schur_rejected_ = false;
+    }
+
+
+
+
+    void IncrementalLinearSolver::reset()
+    {
+        ia_.clear();
+        ja_.clear();
+        x_prev_.clear();
+        sa_prev_.clear();
+        rhs_prev_.clear();
+        schur_valid_ = false;
+        schur_rejected_ = false;
+    }
+
+
+
+
+    int IncrementalLinearSolver::numSolves() const
+    {
+        return num_solves_;
+    }
+
+
+
+
+    int IncrementalLinearSolver::numSkippedSolves() const
+    {
+        return num_skipped_;
+    }
+
+
+
+
+    int IncrementalLinearSolver::numSchurSolves() const
+    {
+        return num_schur_;
+    }
+
+
+
+
+    bool IncrementalLinearSolver::samePattern(const int size, const int nonzeros,
+                                              const int* ia, const int* ja) const
+    {
+        if (int(ia_.size()) != size + 1 || int(ja_.size()) != nonzeros) {
+            return false;
+        }
+        return std::equal(ia_.begin(), ia_.end(), ia)
+            && std::equal(ja_.begin(), ja_.end(), ja);
+    }
+
+
+
+
+    bool IncrementalLinearSolver::sameReservoirRows(const double* sa, const double* rhs) const
+    {
+        // Pattern is known to be unchanged, so ia_ describes sa as well.
+        const int nr = num_reservoir_;
+        if (rhs_prev_.empty()) {
+            return false;
+        }
+        return std::equal(rhs_prev_.begin(), rhs_prev_.begin() + nr, rhs)
+            && std::equal(sa_prev_.begin(), sa_prev_.begin() + ia_[nr], sa);
+    }
+
+
+
+
+    IncrementalLinearSolver::SchurResult
+    IncrementalLinearSolver::solveWellSchur(const int size,
+                                            const int* ia,
+                                            const int* ja,
+                                            const double* sa,
+                                            const double* rhs,
+                                            double* solution,
+                                            LinearSolverReport& rpt) const
+    {
+        const int nr = num_reservoir_;
+        const int nw = size - nr;
+
+        if (!schur_valid_) {
+            // Extract the reservoir block A_rr and factorise it. The
+            // pattern is the same as long as the system pattern is, so
+            // the ordering and symbolic analysis are kept.
+            if (!rr_factor_) {
+                rr_factor_.reset(new ReservoirFactor);
+            }
+            ReservoirFactor& factor = *rr_factor_;
+            std::vector< Eigen::Triplet<double> > triplets;
+            triplets.reserve(ia[nr]);
+            for (int row = 0; row < nr; ++row) {
+                for (int k = ia[row]; k < ia[row + 1]; ++k) {
+                    if (ja[k] < nr) {
+                        triplets.push_back(Eigen::Triplet<double>(row, ja[k], sa[k]));
+                    }
+                }
+            }
+            const bool same_size = factor.matrix.rows() == nr;
+            factor.matrix.resize(nr, nr);
+            factor.matrix.setFromTriplets(triplets.begin(), triplets.end());
+            factor.matrix.makeCompressed();
+            if (!factor.analyzed || !same_size) {
+                factor.lu.analyzePattern(factor.matrix);
+                factor.analyzed = true;
+            }
+            factor.lu.factorize(factor.matrix);
+            if (factor.lu.info() != Eigen::Success) {
+                factor.analyzed = false;
+                schur_rejected_ = true;
+                return SchurFailed;
+            }
+
+            // Right hand sides [b_r, A_rw], solved with the one
+            // factorisation: y = A_rr^{-1} b_r, Z = A_rr^{-1} A_rw.
+            Eigen::MatrixXd b(nr, nw + 1);
+            b.setZero();
+            b.col(0) = Eigen::Map<const Eigen::VectorXd>(rhs, nr);
+            for (int row = 0; row < nr; ++row) {
+                for (int k = ia[row]; k < ia[row + 1]; ++k) {
+                    if (ja[k] >= nr) {
+                        b(row, 1 + ja[k] - nr) = sa[k];
+                    }
+                }
+            }
+            const Eigen::MatrixXd x = factor.lu.solve(b);
+            schur_y_.assign(x.data(), x.data() + nr);
+            schur_z_.assign(x.data() + nr, x.data() + nr*(nw + 1));
+            schur_valid_ = true;
+        }
+
+        // Schur complement S = A_ww - A_wr Z and right hand side
+        // g = b_w - A_wr y.
+        std::vector<double> S(nw*nw, 0.0);
+        std::vector<double> g(rhs + nr, rhs + size);
+        for (int i = 0; i < nw; ++i) {
+            const int row = nr + i;
+            for (int k = ia[row]; k < ia[row + 1]; ++k) {
+                const int col = ja[k];
+                if (col >= nr) {
+                    S[i*nw + col - nr] += sa[k];
+                } else {
+                    g[i] -= sa[k]*schur_y_[col];
+                    for (int j = 0; j < nw; ++j) {
+                        S[i*nw + j] -= sa[k]*schur_z_[j*nr + col];
+                    }
+                }
+            }
+        }
+        if (!denseSolve(nw, S, g)) {
+            return SchurFailed;
+        }
+
+        // Back substitution, x_r = y - Z x_w.
+        for (int row = 0; row < nr; ++row) {
+            double x = schur_y_[row];
+            for (int j = 0; j < nw; ++j) {
+                x -= schur_z_[j*nr + row]*g[j];
+            }
+            solution[row] = x;
+        }
+        std::copy(g.begin(), g.end(), solution + nr);
+
+        // Report the residual reduction actually achieved.
+        double rhs_norm = 0.0;
+        double res_norm = 0.0;
+        for (int row = 0; row < size; ++row) {
+            double r = rhs[row];
+            for (int k = ia[row]; k < ia[row + 1]; ++k) {
+                r -= sa[k]*solution[ja[k]];
+            }
+            rhs_norm += rhs[row]*rhs[row];
+            res_norm += r*r;
+        }
+        const double reduction = (rhs_norm > 0.0) ? std::sqrt(res_norm/rhs_norm) : 0.0;
+        const double tol = linsolver_.getTolerance();
+        if (tol > 0.0 && !(reduction <= tol)) {
+            // Not accurate enough for the combined system, leave it to
+            // a full solve starting from this solution.
+            schur_rejected_ = true;
+            return SchurInaccurate;
+        }
+        rpt.converged = true;
+        rpt.iterations = 0;
+        rpt.residual_reduction = reduction;
+        return SchurSolved;
+    }
+
+
+
+
+    void IncrementalLinearSolver::store(const int size, const int nonzeros,
+                                        const int* ia, const int* ja,
+                                        const double* sa, const double* rhs,
+                                        const double* solution) const
+    {
+        ia_.assign(ia, ia + size + 1);
+        ja_.assign(ja, ja + nonzeros);
+        x_prev_.assign(solution, solution + size);
+        if (num_reservoir_ > 0) {
+            sa_prev_.assign(sa, sa + nonzeros);
+            rhs_prev_.assign(rhs, rhs + size);
+        }
+    }
+
+
+} // namespace Opm
@@ -0,0 +1,170 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_INCREMENTALLINEARSOLVER_HEADER_INCLUDED
+#define OPM_INCREMENTALLINEARSOLVER_HEADER_INCLUDED
+
+#include <opm/core/linalg/LinearSolverInterface.hpp>
+#include <boost/any.hpp>
+#include <memory>
+#include <vector>
+
+namespace Opm
+{
+
+    /// Linear solver wrapper warm-starting every solve from the
+    /// solution of the previous one.
+    ///
+    /// The pressure systems of consecutive solves (in particular the
+    /// repeated solves of the well control loop) share the sparsity
+    /// pattern and differ only slightly in their coefficients. When
+    /// the pattern of a system matches the previous one, this class
+    /// solves for the correction to the previous solution instead,
+    /// scaling the relative tolerance of the wrapped solver such that
+    /// the final residual reduction, measured against the right hand
+    /// side, is unchanged. If the previous solution already meets the
+    /// tolerance, the wrapped solver is not called at all.
+    /// Direct solvers (reporting a non-positive tolerance) and
+    /// parallel solves are passed through unchanged.
+    ///
+    /// Optionally, systems where the last unknowns are well unknowns
+    /// (as assembled by the incompressible tpfa solver) can be
+    /// re-solved through a Schur complement with respect to the well
+    /// unknowns. When only the well rows changed since the previous
+    /// solve, as happens when the well control loop switches
+    /// controls, the reservoir block A_rr is factorised once by a
+    /// sparse LU and A_rr^{-1} b_r and A_rr^{-1} A_rw are found from
+    /// that one factorisation, all right hand sides at once. The
+    /// factorisation is kept for as long as the reservoir rows do not
+    /// change, and every further re-solve only requires a small dense
+    /// solve. The storage of A_rr^{-1} A_rw is one reservoir vector per
+    /// well. A Schur solution whose residual reduction misses the
+    /// tolerance of the wrapped solver is used as the starting point
+    /// of a full solve.
+    class IncrementalLinearSolver : public LinearSolverInterface
+    {
+    public:
+        /// Construct from the solver doing the actual work.
+        /// \param[in] linsolver  wrapped linear solver.
+        explicit IncrementalLinearSolver(LinearSolverInterface& linsolver);
+
+        /// Destructor.
+        virtual ~IncrementalLinearSolver();
+
+        using LinearSolverInterface::solve;
+
+        /// Solve a linear system, with a crs-format matrix, warm-started
+        /// from the previous solution if possible.
+        /// \param[in]  size        # of rows in matrix
+        /// \param[in]  nonzeros    # of nonzeros elements in matrix
+        /// \param[in]  ia          array of length (size + 1) containing start and end indices for each row
+        /// \param[in]  ja          array of length nonzeros containing column numbers for the nonzero elements
+        /// \param[in]  sa          array of length nonzeros containing the values of the nonzero elements
+        /// \param[in]  rhs         array of length size containing the right hand side
+        /// \param[inout] solution  array of length size to which the solution will be written
+        /// \param[in]  comm        the communication information, empty for serial runs
+        virtual LinearSolverReport solve(const int size,
+                                         const int nonzeros,
+                                         const int* ia,
+                                         const int* ja,
+                                         const double* sa,
+                                         const double* rhs,
+                                         double* solution,
+                                         const boost::any& comm = boost::any()) const;
+
+        /// Set tolerance for the residual in the wrapped solver.
+        virtual void setTolerance(const double tol);
+
+        /// Get tolerance of the wrapped solver.
+        virtual double getTolerance() const;
+
+        /// Enable or disable warm starting (enabled by default).
+        void setWarmStart(const bool warm_start);
+
+        /// Enable the Schur complement re-solve for systems whose
+        /// first num_reservoir_unknowns unknowns are reservoir unknowns
+        /// and the remaining ones are well unknowns. Zero disables it.
+        /// Systems with more than max_wells well unknowns are always
+        /// solved in full.
+        void setWellSchurComplement(const int num_reservoir_unknowns,
+                                    const int max_wells = 100);
+
+        /// Forget the stored solution, the next solve starts from zero.
+        void reset();
+
+        /// Number of solves requested so far.
+        int numSolves() const;
+
+        /// Number of solves that were satisfied by the stored solution
+        /// without calling the wrapped solver.
+        int numSkippedSolves() const;
+
+        /// Number of solves done through the well Schur complement.
+        int numSchurSolves() const;
+
+    private:
+        bool samePattern(const int size, const int nonzeros,
+                         const int* ia, const int* ja) const;
+        bool sameReservoirRows(const double* sa, const double* rhs) const;
+        enum SchurResult { SchurSolved, SchurInaccurate, SchurFailed };
+        SchurResult solveWellSchur(const int size,
+                                   const int* ia,
+                                   const int* ja,
+                                   const double* sa,
+                                   const double* rhs,
+                                   double* solution,
+                                   LinearSolverReport& rpt) const;
+        void store(const int size, const int nonzeros,
+                   const int* ia, const int* ja,
+                   const double* sa, const double* rhs,
+                   const double* solution) const;
+
+        LinearSolverInterface& linsolver_;
+        bool warm_start_;
+        int num_reservoir_;
+        int max_schur_wells_;
+        // Pattern and solution of the previous system.
+        mutable std::vector<int> ia_;
+        mutable std::vector<int> ja_;
+        mutable std::vector<double> x_prev_;
+        // Coefficients and right hand side of the previous system,
+        // only kept if the Schur complement re-solve is enabled.
+        mutable std::vector<double> sa_prev_;
+        mutable std::vector<double> rhs_prev_;
+        // Work arrays for the correction system.
+        mutable std::vector<double> residual_;
+        mutable std::vector<double> correction_;
+        // Reservoir block data for the Schur complement: the LU factors
+        // of the block, y = A_rr^{-1} b_r and Z = A_rr^{-1} A_rw (column
+        // major). The Schur re-solve is skipped until the reservoir rows
+        // change once it has failed to reach the tolerance.
+        struct ReservoirFactor;
+        mutable bool schur_valid_;
+        mutable bool schur_rejected_;
+        mutable std::unique_ptr<ReservoirFactor> rr_factor_;
+        mutable std::vector<double> schur_y_;
+        mutable std::vector<double> schur_z_;
+        mutable int num_solves_;
+        mutable int num_skipped_;
+        mutable int num_schur_;
+    };
+
+} // namespace Opm
+
+#endif // OPM_INCREMENTALLINEARSOLVER_HEADER_INCLUDED
@@ -0,0 +1,217 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <config.h>
+
+#include <opm/polymer/InexactNewtonLinearSolver.hpp>
+
+#include <Eigen/Dense>
+
+#include <algorithm>
+#include <cmath>
+
+namespace Opm
+{
+
+
+    InexactNewtonLinearSolver::InexactNewtonLinearSolver(LinearSolverInterface& linsolver)
+        : linsolver_(linsolver),
+          eta_max_(0.0),
+          anderson_depth_(0),
+          prev_res_norm_(-1.0),
+          prev_eta_(0.0),
+          num_solves_(0)
+    {
+    }
+
+
+
+
+    InexactNewtonLinearSolver::~InexactNewtonLinearSolver()
+    {
+    }
+
+
+
+
+    LinearSolverInterface::LinearSolverReport
+    InexactNewtonLinearSolver::solve(const int size,
+                                     const int nonzeros,
+                                     const int* ia,
+                                     const int* ja,
+                                     const double* sa,
+                                     const double* rhs,
+                                     double* solution,
+                                     const boost::any& comm) const
+    {
+        ++num_solves_;
+        const double tol = linsolver_.getTolerance();
+        LinearSolverReport rpt;
+        if (eta_max_ > 0.0 && tol > 0.0 && comm.empty()) {
+            // Eisenstat-Walker forcing term, choice 2 with gamma = 0.9, alpha = 2.
+            double res_norm = 0.0;
+            for (int row = 0; row < size; ++row) {
+                res_norm += rhs[row]*rhs[row];
+            }
+            res_norm = std::sqrt(res_norm);
+            double eta = eta_max_;
+            if (prev_res_norm_ > 0.0) {
+                const double ratio = res_norm/prev_res_norm_;
+                eta = 0.9*ratio*ratio;
+                const double safeguard = 0.9*prev_eta_*prev_eta_;
+                if (safeguard > 0.1) {
+                    eta = std::max(eta, safeguard);
+                }
+                eta = std::min(eta, eta_max_);
+            }
+            eta = std::max(eta, tol);
+            prev_res_norm_ = res_norm;
+            prev_eta_ = eta;
+
+            linsolver_.setTolerance(eta);
+            try {
+                rpt = linsolver_.solve(size, nonzeros, ia, ja, sa, rhs, solution, comm);
+            }
+            catch (...) {
+                linsolver_.setTolerance(tol);
+                throw;
+            }
+            linsolver_.setTolerance(tol);
+        } else {
+            rpt = linsolver_.solve(size, nonzeros, ia, ja, sa, rhs, solution, comm);
+        }
+
+        if (anderson_depth_ > 0 && comm.empty()) {
+            andersonMix(size, solution);
+        }
+        return rpt;
+    }
+
+
+
+
+    void InexactNewtonLinearSolver::setTolerance(const double tol)
+    {
+        linsolver_.setTolerance(tol);
+    }
+
+
+
+
+    double InexactNewtonLinearSolver::getTolerance() const
+    {
+        return linsolver_.getTolerance();
+    }
+
+
+
+
+    void InexactNewtonLinearSolver::setForcing(const double eta_max)
+    {
+        eta_max_ = eta_max;
+    }
+
+
+
+
+    void InexactNewtonLinearSolver::setAndersonDepth(const int depth)
+    {
+        anderson_depth_ = std::max(depth, 0);
+        beginNewton();
+    }
+
+
+
+
+    void InexactNewtonLinearSolver::beginNewton()
+    {
+        prev_res_norm_ = -1.0;
+        prev_eta_ = 0.0;
+        u_.clear();
+        f_hist_.clear();
+        g_hist_.clear();
+    }
+
+
+
+
+    int InexactNewtonLinearSolver::numSolves() const
+    {
+        return num_solves_;
+    }
+
+
+
+
+    // Anderson mixing (type II) of the map g(x) = x - dx(x), written in
+    // terms of u = x - x_0 since the iterates themselves are not known.
+    void InexactNewtonLinearSolver::andersonMix(const int size, double* solution) const
+    {
+        if (int(u_.size()) != size) {
+            u_.assign(size, 0.0);
+            f_hist_.clear();
+            g_hist_.clear();
+        }
+
+        // Record f_k = -dx_k and g_k = u_k - dx_k.
+        if (int(f_hist_.size()) == anderson_depth_ + 1) {
+            f_hist_.erase(f_hist_.begin());
+            g_hist_.erase(g_hist_.begin());
+        }
+        f_hist_.push_back(std::vector<double>(size));
+        g_hist_.push_back(std::vector<double>(size));
+        std::vector<double>& fk = f_hist_.back();
+        std::vector<double>& gk = g_hist_.back();
+        for (int i = 0; i < size; ++i) {
+            fk[i] = -solution[i];
+            gk[i] = u_[i] - solution[i];
+        }
+
+        std::vector<double> u_new = gk;
+        const int m = f_hist_.size() - 1;
+        if (m > 0) {
+            // Minimise |f_k - dF gamma| over the differences of the history.
+            Eigen::MatrixXd dF(size, m);
+            for (int j = 0; j < m; ++j) {
+                for (int i = 0; i < size; ++i) {
+                    dF(i, j) = f_hist_[j + 1][i] - f_hist_[j][i];
+                }
+            }
+            const Eigen::Map<const Eigen::VectorXd> f(&fk[0], size);
+            const Eigen::VectorXd gamma = dF.colPivHouseholderQr().solve(f);
+            for (int j = 0; j < m; ++j) {
+                if (!std::isfinite(gamma[j])) {
+                    u_new = gk;
+                    break;
+                }
+                for (int i = 0; i < size; ++i) {
+                    u_new[i] -= gamma[j]*(g_hist_[j + 1][i] - g_hist_[j][i]);
+                }
+            }
+        }
+
+        // Return the increment giving the mixed iterate.
+        for (int i = 0; i < size; ++i) {
+            solution[i] = u_[i] - u_new[i];
+        }
+        u_.swap(u_new);
+    }
+
+
+} // namespace Opm
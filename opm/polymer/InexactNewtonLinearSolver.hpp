@@ -0,0 +1,117 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_INEXACTNEWTONLINEARSOLVER_HEADER_INCLUDED
+#define OPM_INEXACTNEWTONLINEARSOLVER_HEADER_INCLUDED
+
+#include <opm/core/linalg/LinearSolverInterface.hpp>
+#include <boost/any.hpp>
+#include <vector>
+
+namespace Opm
+{
+
+    /// Linear solver wrapper for the Jacobian systems J dx = F of a
+    /// Newton iteration updating x := x - dx, such as the one of
+    /// CompressibleTpfa.
+    ///
+    /// Two independent accelerations are offered:
+    ///  - An inexact Newton forcing term (Eisenstat-Walker, choice 2).
+    ///    The relative tolerance of the wrapped iterative solver is
+    ///    chosen from the reduction of the nonlinear residual |F|
+    ///    between iterations, bounded below by the tolerance set by
+    ///    the user, so that early iterations are not oversolved.
+    ///  - Anderson acceleration of depth m, applied to the fixed point
+    ///    map x -> x - dx. The returned increment is replaced by the
+    ///    one giving the Anderson mixed iterate of the last m + 1
+    ///    iterates.
+    /// Call beginNewton() before every nonlinear solve to clear the
+    /// history. With both features disabled the wrapped solver is
+    /// called unchanged.
+    class InexactNewtonLinearSolver : public LinearSolverInterface
+    {
+    public:
+        /// Construct from the solver doing the actual work.
+        /// \param[in] linsolver  wrapped linear solver.
+        explicit InexactNewtonLinearSolver(LinearSolverInterface& linsolver);
+
+        /// Destructor.
+        virtual ~InexactNewtonLinearSolver();
+
+        using LinearSolverInterface::solve;
+
+        /// Solve a Newton system, with a crs-format matrix.
+        /// \param[in]  size        # of rows in matrix
+        /// \param[in]  nonzeros    # of nonzeros elements in matrix
+        /// \param[in]  ia          array of length (size + 1) containing start and end indices for each row
+        /// \param[in]  ja          array of length nonzeros containing column numbers for the nonzero elements
+        /// \param[in]  sa          array of length nonzeros containing the values of the nonzero elements
+        /// \param[in]  rhs         array of length size containing the nonlinear residual
+        /// \param[inout] solution  array of length size to which the increment will be written
+        /// \param[in]  comm        the communication information, empty for serial runs
+        virtual LinearSolverReport solve(const int size,
+                                         const int nonzeros,
+                                         const int* ia,
+                                         const int* ja,
+                                         const double* sa,
+                                         const double* rhs,
+                                         double* solution,
+                                         const boost::any& comm = boost::any()) const;
+
+        /// Set the tolerance of the wrapped solver. With the forcing
+        /// term enabled this is the tightest tolerance used.
+        virtual void setTolerance(const double tol);
+
+        /// Get tolerance of the wrapped solver.
+        virtual double getTolerance() const;
+
+        /// Enable the forcing term.
+        /// \param[in] eta_max  loosest relative tolerance allowed,
+        ///                     non-positive values disable the forcing term.
+        void setForcing(const double eta_max);
+
+        /// Enable Anderson acceleration of the given depth, zero disables it.
+        void setAndersonDepth(const int depth);
+
+        /// Start a new nonlinear solve, clearing all history.
+        void beginNewton();
+
+        /// Number of linear solves since construction.
+        int numSolves() const;
+
+    private:
+        void andersonMix(const int size, double* solution) const;
+
+        LinearSolverInterface& linsolver_;
+        double eta_max_;
+        int anderson_depth_;
+        // Forcing term history.
+        mutable double prev_res_norm_;
+        mutable double prev_eta_;
+        // Anderson history: u = x - x_0 of the current iterate, and the
+        // last iterates of f = -dx and g = u - dx.
+        mutable std::vector<double> u_;
+        mutable std::vector< std::vector<double> > f_hist_;
+        mutable std::vector< std::vector<double> > g_hist_;
+        mutable int num_solves_;
+    };
+
+} // namespace Opm
+
+#endif // OPM_INEXACTNEWTONLINEARSOLVER_HEADER_INCLUDED
@@ -28,7 +28,12 @@
 #include <opm/parser/eclipse/EclipseState/Schedule/ScheduleEnums.hpp>
 #include <opm/parser/eclipse/EclipseState/Schedule/WellPolymerProperties.hpp>
 #include <opm/parser/eclipse/EclipseState/Schedule/WellInjectionProperties.hpp>
+#include <opm/parser/eclipse/EclipseState/Schedule/TimeMap.hpp>
+#include <opm/core/utility/Units.hpp>
+#include <algorithm>
+#include <fstream>
 #include <map>
+#include <sstream>
 #include <unordered_map>
 #include <memory>
 namespace Opm
@@ -125,14 +130,13 @@ namespace Opm
             DeckRecordConstPtr record = keyword->getRecord(recordNr);
 
             const std::string& wellNamesPattern = record->getItem("WELL")->getTrimmedString(0);
-            std::string wellName = record->getItem("WELL")->getTrimmedString(0);
             std::vector<WellPtr> wells = schedule->getWells(wellNamesPattern);
             for (auto wellIter = wells.begin(); wellIter != wells.end(); ++wellIter) {
                 WellPtr well = *wellIter;
                 WellInjectionProperties injection = well->getInjectionProperties(currentStep);
                 if (injection.injectorType == WellInjector::WATER) {
                     WellPolymerProperties polymer = well->getPolymerProperties(currentStep);
-                    wellPolymerRate_.insert(std::make_pair(wellName, polymer.m_polymerConcentration));
+                    wellPolymerRate_.insert(std::make_pair(well->name(), polymer.m_polymerConcentration));
                 } else {
                     OPM_THROW(std::logic_error, "For polymer injector you must have a water injector");
                 }
@@ -164,7 +168,7 @@ namespace Opm
             // names.
             int wix = 0;
             for (; wix < wells.number_of_wells; ++wix) {
-                if (wellPolymerRate_.count(wells.name[wix]) > 0) {
+                if (map_it->first == wells.name[wix]) {
                     break;
                 }
             }
@@ -202,4 +206,269 @@ namespace Opm
     }
 
 
+
+    // ---------- Methods of PolymerInflowSchedule ----------
+
+
+    PolymerInflowSchedule::PolymerInflowSchedule(Opm::EclipseStateConstPtr eclipseState)
+        : interpolation_(Stepwise),
+          sparse_inflow_(0),
+          inflow_start_(0.0),
+          inflow_end_(0.0),
+          inflow_wells_(0)
+    {
+        ScheduleConstPtr schedule = eclipseState->getSchedule();
+        TimeMapConstPtr timeMap = schedule->getTimeMap();
+        const size_t num_steps = timeMap->numTimesteps();
+        std::vector<WellConstPtr> wells = schedule->getWells();
+        for (auto wellIter = wells.begin(); wellIter != wells.end(); ++wellIter) {
+            WellConstPtr well = *wellIter;
+            // Report steps where the concentration changes, at the start time of the step.
+            Table table;
+            double previous = 0.0;
+            double step_time = 0.0;
+            for (size_t step = 0; step < num_steps; ++step) {
+                double conc = well->getPolymerProperties(step).m_polymerConcentration;
+                if (conc != 0.0 && well->isInjector(step)
+                    && well->getInjectionProperties(step).injectorType != WellInjector::WATER) {
+                    OPM_THROW(std::logic_error, "For polymer injector you must have a water injector");
+                }
+                if (!well->isInjector(step)) {
+                    conc = 0.0;
+                }
+                if (conc != previous) {
+                    table.push_back(std::make_pair(step_time, conc));
+                    previous = conc;
+                }
+                step_time += timeMap->getTimeStepLength(step);
+            }
+            addTable(well->name(), table);
+        }
+    }
+
+
+
+
+    PolymerInflowSchedule::PolymerInflowSchedule(const std::unordered_map<std::string, Table>& tables,
+                                                 const Interpolation interpolation)
+        : interpolation_(interpolation),
+          sparse_inflow_(0),
+          inflow_start_(0.0),
+          inflow_end_(0.0),
+          inflow_wells_(0)
+    {
+        for (auto it = tables.begin(); it != tables.end(); ++it) {
+            addTable(it->first, it->second);
+        }
+    }
+
+
+
+
+    PolymerInflowSchedule::PolymerInflowSchedule(const std::string& filename,
+                                                 const Interpolation interpolation)
+        : interpolation_(interpolation),
+          sparse_inflow_(0),
+          inflow_start_(0.0),
+          inflow_end_(0.0),
+          inflow_wells_(0)
+    {
+        std::ifstream is(filename.c_str());
+        if (!is) {
+            OPM_THROW(std::runtime_error, "Could not open polymer schedule file " << filename);
+        }
+        std::unordered_map<std::string, Table> tables;
+        std::string line;
+        int line_no = 0;
+        while (std::getline(is, line)) {
+            ++line_no;
+            std::istringstream iss(line);
+            std::string well_name;
+            if (!(iss >> well_name) || well_name.compare(0, 2, "--") == 0) {
+                continue;
+            }
+            double days = 0.0;
+            double conc = 0.0;
+            if (!(iss >> days >> conc)) {
+                OPM_THROW(std::runtime_error, "Could not read line " << line_no
+                          << " of polymer schedule file " << filename);
+            }
+            tables[well_name].push_back(std::make_pair(days*unit::day, conc));
+        }
+        for (auto it = tables.begin(); it != tables.end(); ++it) {
+            Table& table = it->second;
+            std::stable_sort(table.begin(), table.end(),
+                             [](const std::pair<double, double>& a, const std::pair<double, double>& b) {
+                                 return a.first < b.first;
+                             });
+            addTable(it->first, table);
+        }
+    }
+
+
+
+
+    void PolymerInflowSchedule::addTable(const std::string& well_name, const Table& table)
+    {
+        Timeline& timeline = timeline_[well_name];
+        const int n = table.size();
+        timeline.time.resize(n);
+        timeline.conc.resize(n);
+        timeline.integral.resize(n);
+        for (int k = 0; k < n; ++k) {
+            timeline.time[k] = table[k].first;
+            timeline.conc[k] = table[k].second;
+            if (k == 0) {
+                timeline.integral[k] = 0.0;
+                continue;
+            }
+            const double dt = timeline.time[k] - timeline.time[k - 1];
+            if (dt < 0.0) {
+                OPM_THROW(std::runtime_error, "Polymer schedule of well " << well_name
+                          << " is not in increasing order of time.");
+            }
+            const double avg = (interpolation_ == Linear)
+                ? 0.5*(timeline.conc[k - 1] + timeline.conc[k])
+                : timeline.conc[k - 1];
+            timeline.integral[k] = timeline.integral[k - 1] + avg*dt;
+        }
+    }
+
+
+
+
+    // Integral of the concentration from the first time of the table to t.
+    double PolymerInflowSchedule::integral(const Timeline& timeline, const double t) const
+    {
+        // Last time at or before t.
+        const int k = int(std::upper_bound(timeline.time.begin(), timeline.time.end(), t)
+                          - timeline.time.begin()) - 1;
+        if (k < 0) {
+            return 0.0;
+        }
+        const double dt = t - timeline.time[k];
+        const int last = timeline.time.size() - 1;
+        if (interpolation_ == Stepwise || k == last) {
+            return timeline.integral[k] + timeline.conc[k]*dt;
+        }
+        const double slope = (timeline.conc[k + 1] - timeline.conc[k])
+            / (timeline.time[k + 1] - timeline.time[k]);
+        return timeline.integral[k] + dt*(timeline.conc[k] + 0.5*slope*dt);
+    }
+
+
+
+
+    double PolymerInflowSchedule::wellConcentration(const std::string& well_name,
+                                                    const double step_start,
+                                                    const double step_end) const
+    {
+        const auto it = timeline_.find(well_name);
+        if (it == timeline_.end() || it->second.time.empty()) {
+            return 0.0;
+        }
+        const Timeline& timeline = it->second;
+        if (step_end > step_start) {
+            return (integral(timeline, step_end) - integral(timeline, step_start)) / (step_end - step_start);
+        }
+        // Empty interval: the concentration at step_start.
+        const int k = int(std::upper_bound(timeline.time.begin(), timeline.time.end(), step_start)
+                          - timeline.time.begin()) - 1;
+        if (k < 0) {
+            return 0.0;
+        }
+        const int last = timeline.time.size() - 1;
+        if (interpolation_ == Stepwise || k == last) {
+            return timeline.conc[k];
+        }
+        const double w = (step_start - timeline.time[k]) / (timeline.time[k + 1] - timeline.time[k]);
+        return (1.0 - w)*timeline.conc[k] + w*timeline.conc[k + 1];
+    }
+
+
+
+
+    const SparseVector<double>& PolymerInflowSchedule::inflow(const double step_start,
+                                                              const double step_end,
+                                                              const Wells& wells,
+                                                              const int num_cells)
+    {
+        if (inflow_wells_ == &wells && inflow_start_ == step_start && inflow_end_ == step_end
+            && sparse_inflow_.size() == num_cells) {
+            return sparse_inflow_;
+        }
+        // Cells in increasing order; a cell perforated by several wells
+        // takes the concentration of the last one, as in PolymerInflowFromDeck.
+        std::vector< std::pair<int, double> > perfcell_conc;
+        for (int w = 0; w < wells.number_of_wells; ++w) {
+            const double conc = wellConcentration(wells.name[w], step_start, step_end);
+            if (conc == 0.0) {
+                continue;
+            }
+            for (int j = wells.well_connpos[w]; j < wells.well_connpos[w + 1]; ++j) {
+                perfcell_conc.push_back(std::make_pair(wells.well_cells[j], conc));
+            }
+        }
+        std::stable_sort(perfcell_conc.begin(), perfcell_conc.end(),
+                         [](const std::pair<int, double>& a, const std::pair<int, double>& b) {
+                             return a.first < b.first;
+                         });
+        sparse_inflow_ = SparseVector<double>(num_cells);
+        for (std::size_t i = 0; i < perfcell_conc.size(); ++i) {
+            if (i + 1 < perfcell_conc.size() && perfcell_conc[i + 1].first == perfcell_conc[i].first) {
+                continue;
+            }
+            sparse_inflow_.addElement(perfcell_conc[i].second, perfcell_conc[i].first);
+        }
+        inflow_start_ = step_start;
+        inflow_end_ = step_end;
+        inflow_wells_ = &wells;
+        return sparse_inflow_;
+    }
+
+
+
+
+    void PolymerInflowSchedule::getPerfInflowValues(const double step_start,
+                                                    const double step_end,
+                                                    const Wells& wells,
+                                                    std::vector<double>& perf_conc) const
+    {
+        perf_conc.resize(wells.well_connpos[wells.number_of_wells]);
+        for (int w = 0; w < wells.number_of_wells; ++w) {
+            const double conc = wellConcentration(wells.name[w], step_start, step_end);
+            std::fill(perf_conc.begin() + wells.well_connpos[w],
+                      perf_conc.begin() + wells.well_connpos[w + 1], conc);
+        }
+    }
+
+
+    // ---------- Methods of PolymerInflowFromSchedule ----------
+
+
+    PolymerInflowFromSchedule::PolymerInflowFromSchedule(PolymerInflowSchedule& schedule,
+                                                         const Wells& wells,
+                                                         const int num_cells)
+        : schedule_(schedule),
+          wells_(wells),
+          num_cells_(num_cells)
+    {
+    }
+
+
+
+
+    void PolymerInflowFromSchedule::getInflowValues(const double step_start,
+                                                    const double step_end,
+                                                    std::vector<double>& poly_inflow_c) const
+    {
+        const SparseVector<double>& sparse = schedule_.inflow(step_start, step_end, wells_, num_cells_);
+        std::fill(poly_inflow_c.begin(), poly_inflow_c.end(), 0.0);
+        const int nnz = sparse.nonzeroSize();
+        for (int i = 0; i < nnz; ++i) {
+            poly_inflow_c[sparse.nonzeroIndex(i)] = sparse.nonzeroElement(i);
+        }
+    }
+
+
 } // namespace Opm
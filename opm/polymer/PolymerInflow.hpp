@@ -26,9 +26,11 @@
 #include <opm/parser/eclipse/EclipseState/Schedule/Schedule.hpp>
 #include <opm/parser/eclipse/EclipseState/EclipseState.hpp>
 #include <opm/parser/eclipse/EclipseState/Schedule/WellPolymerProperties.hpp>
-#include <vector>
+#include <cstddef>
 #include <string>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 struct Wells;
 
@@ -125,6 +127,134 @@ namespace Opm
     };
 
 
+    /// @brief Polymer injection of a whole simulation, as a function of
+    /// time for every well.
+    /// The concentrations are given at a set of times per well, either
+    /// from the WPOLYMER settings of the schedule (held constant over
+    /// the report steps) or from a table (held constant or linearly
+    /// interpolated between its times). The concentration used for a
+    /// time step is the exact time average over the step, found by a
+    /// binary search in the cumulative integral of the concentration.
+    /// Unlike PolymerInflowFromDeck, which holds one report step, this
+    /// class is built once for the whole simulation.
+    class PolymerInflowSchedule
+    {
+    public:
+        /// How the concentration varies between the times of a table.
+        enum Interpolation { Stepwise, Linear };
+
+        /// Concentrations of one well: pairs of time (seconds) and
+        /// concentration, in increasing order of time.
+        typedef std::vector< std::pair<double, double> > Table;
+
+        /// Constructor.
+        /// \param[in]  eclipseState  Eclipse state, whose schedule holds the WPOLYMER settings.
+        explicit PolymerInflowSchedule(Opm::EclipseStateConstPtr eclipseState);
+
+        /// Constructor.
+        /// Before its first time a well injects no polymer; after its
+        /// last time it keeps the last concentration.
+        /// \param[in]  tables         Concentration table per well name.
+        /// \param[in]  interpolation  Variation between the times of the tables.
+        PolymerInflowSchedule(const std::unordered_map<std::string, Table>& tables,
+                              const Interpolation interpolation);
+
+        /// Constructor.
+        /// Reads the tables from a text file where every line holds a
+        /// well name, a time in days and a concentration in kg/m^3.
+        /// Lines starting with -- are comments.
+        /// \param[in]  filename       Name of the file.
+        /// \param[in]  interpolation  Variation between the times of the tables.
+        PolymerInflowSchedule(const std::string& filename,
+                              const Interpolation interpolation);
+
+        /// Average polymer concentration of a well over a time interval,
+        /// zero for wells unknown to the schedule.
+        /// \param[in]  well_name   Name of the well.
+        /// \param[in]  step_start  Start of timestep.
+        /// \param[in]  step_end    End of timestep.
+        double wellConcentration(const std::string& well_name,
+                                 const double step_start,
+                                 const double step_end) const;
+
+        /// Injection concentrations over a time step, per perforated cell.
+        /// The vector is rebuilt only when the step or the wells change.
+        /// \param[in]  step_start  Start of timestep.
+        /// \param[in]  step_end    End of timestep.
+        /// \param[in]  wells       Wells structure of the time step.
+        /// \param[in]  num_cells   Number of cells in grid.
+        /// \return                  Sparse vector of length num_cells.
+        const SparseVector<double>& inflow(const double step_start,
+                                           const double step_end,
+                                           const Wells& wells,
+                                           const int num_cells);
+
+        /// Injection concentrations over a time step, per perforation
+        /// of the wells in the order of wells.well_cells.
+        /// \param[in]  step_start  Start of timestep.
+        /// \param[in]  step_end    End of timestep.
+        /// \param[in]  wells       Wells structure of the time step.
+        /// \param[out] perf_conc   Concentration of every perforation, resized.
+        void getPerfInflowValues(const double step_start,
+                                 const double step_end,
+                                 const Wells& wells,
+                                 std::vector<double>& perf_conc) const;
+
+    private:
+        // Concentration of a well: the times of the table, the
+        // concentrations at those times and the integral of the
+        // concentration from the first time to each time.
+        struct Timeline
+        {
+            std::vector<double> time;
+            std::vector<double> conc;
+            std::vector<double> integral;
+        };
+
+        void addTable(const std::string& well_name, const Table& table);
+        double integral(const Timeline& timeline, const double t) const;
+
+        Interpolation interpolation_;
+        std::unordered_map<std::string, Timeline> timeline_;
+
+        // Inflow of the last time step asked for.
+        SparseVector<double> sparse_inflow_;
+        double inflow_start_;
+        double inflow_end_;
+        const Wells* inflow_wells_;
+    };
+
+
+
+    /// @brief Polymer injection behaviour class using a PolymerInflowSchedule.
+    /// This class gives the inflow of a PolymerInflowSchedule to the
+    /// simulators using the PolymerInflowInterface.
+    class PolymerInflowFromSchedule : public PolymerInflowInterface
+    {
+    public:
+        /// Constructor.
+        /// \param[in]  schedule    Polymer injection of all wells, must outlive this object.
+        /// \param[in]  wells       Wells structure, must outlive this object.
+        /// \param[in]  num_cells   Number of cells in grid.
+        PolymerInflowFromSchedule(PolymerInflowSchedule& schedule,
+                                  const Wells& wells,
+                                  const int num_cells);
+
+        /// Get inflow concentrations for all cells.
+        /// \param[in]  step_start     Start of timestep.
+        /// \param[in]  step_end       End of timestep.
+        /// \param[out] poly_inflow_c  Injection concentrations to use for timestep, per cell.
+        ///                            Must be properly sized before calling.
+        virtual void getInflowValues(const double step_start,
+                                     const double step_end,
+                                     std::vector<double>& poly_inflow_c) const;
+    private:
+        PolymerInflowSchedule& schedule_;
+        const Wells& wells_;
+        int num_cells_;
+    };
+
+
 } // namespace Opm
 
 
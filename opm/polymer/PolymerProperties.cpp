@@ -436,10 +436,8 @@ namespace Opm
         std::vector<double> shear_vrf = shearViscosityReductionFactor();
 
         std::vector<double> logShearWaterVel;
-        std::vector<double> logShearVRF;
 
         logShearWaterVel.resize(shear_water_vel.size());
-        logShearVRF.resize(shear_water_vel.size());
 
         // converting the table using the reference condition
         for (size_t i = 0; i < shear_vrf.size(); ++i) {
@@ -454,70 +452,91 @@ namespace Opm
         const double maxShearVel = shear_water_vel.back();
         const double epsilon = std::sqrt(std::numeric_limits<double>::epsilon());
 
-        for (size_t i = 0; i < water_vel.size(); ++i) {
-
-            if (visc_mult[i] - 1. < epsilon || std::abs(water_vel[i]) < minShearVel) {
-                 shear_mult[i] = 1.0;
-                 continue;
-            }
+        // The faces are independent, each thread solves for its share
+        // with its own copy of the scaled table.
+        const int num_vel = water_vel.size();
+        bool failed = false;
+#ifdef _OPENMP
+#pragma omp parallel reduction(||:failed)
+#endif
+        {
+            std::vector<double> logShearVRF(shear_water_vel.size());
+#ifdef _OPENMP
+#pragma omp for schedule(static)
+#endif
+            for (int i = 0; i < num_vel; ++i) {
+
+                if (visc_mult[i] - 1. < epsilon || std::abs(water_vel[i]) < minShearVel) {
+                     shear_mult[i] = 1.0;
+                     continue;
+                }
 
-            for (size_t j = 0; j < shear_vrf.size(); ++j) {
-                logShearVRF[j] = (1 + (visc_mult[i] - 1.0) * shear_vrf[j]) / visc_mult[i];
-                logShearVRF[j] = std::log(logShearVRF[j]);
-            }
+                for (size_t j = 0; j < shear_vrf.size(); ++j) {
+                    logShearVRF[j] = (1 + (visc_mult[i] - 1.0) * shear_vrf[j]) / visc_mult[i];
+                    logShearVRF[j] = std::log(logShearVRF[j]);
+                }
 
-            // const double logWaterVelO = std::log(water_vel[i]);
-            const double logWaterVelO = std::log(std::abs(water_vel[i]));
+                // const double logWaterVelO = std::log(water_vel[i]);
+                const double logWaterVelO = std::log(std::abs(water_vel[i]));
 
-            size_t iIntersection; // finding the intersection on the iIntersectionth table segment
-            bool foundSegment = false;
+                size_t iIntersection; // finding the intersection on the iIntersectionth table segment
+                bool foundSegment = false;
 
-            for (iIntersection = 0; iIntersection < shear_vrf.size() - 1; ++iIntersection) {
+                for (iIntersection = 0; iIntersection < shear_vrf.size() - 1; ++iIntersection) {
 
-                double temp1 = logShearVRF[iIntersection] + logShearWaterVel[iIntersection] - logWaterVelO;
-                double temp2 = logShearVRF[iIntersection + 1] + logShearWaterVel[iIntersection + 1] - logWaterVelO;
+                    double temp1 = logShearVRF[iIntersection] + logShearWaterVel[iIntersection] - logWaterVelO;
+                    double temp2 = logShearVRF[iIntersection + 1] + logShearWaterVel[iIntersection + 1] - logWaterVelO;
 
-                // ignore the cases the temp1 or temp2 is zero first for simplicity.
-                // several more complicated cases remain to be implemented.
-                if( temp1 * temp2 < 0.){
-                    foundSegment = true;
-                    break;
+                    // ignore the cases the temp1 or temp2 is zero first for simplicity.
+                    // several more complicated cases remain to be implemented.
+                    if( temp1 * temp2 < 0.){
+                        foundSegment = true;
+                        break;
+                    }
                 }
-            }
 
-            if (foundSegment == true) {
-                detail::Point2D lineSegment[2];
-                lineSegment[0] = detail::Point2D{logShearWaterVel[iIntersection], logShearVRF[iIntersection]};
-                lineSegment[1] = detail::Point2D{logShearWaterVel[iIntersection + 1], logShearVRF[iIntersection + 1]};
+                if (foundSegment == true) {
+                    detail::Point2D lineSegment[2];
+                    lineSegment[0] = detail::Point2D{logShearWaterVel[iIntersection], logShearVRF[iIntersection]};
+                    lineSegment[1] = detail::Point2D{logShearWaterVel[iIntersection + 1], logShearVRF[iIntersection + 1]};
 
-                detail::Point2D line[2];
-                line[0] = detail::Point2D{0, logWaterVelO};
-                line[1] = detail::Point2D{logWaterVelO, 0};
+                    detail::Point2D line[2];
+                    line[0] = detail::Point2D{0, logWaterVelO};
+                    line[1] = detail::Point2D{logWaterVelO, 0};
 
-                detail::Point2D intersectionPoint;
+                    detail::Point2D intersectionPoint;
 
-                bool foundIntersection = detail::Point2D::findIntersection(lineSegment, line, intersectionPoint);
+                    bool foundIntersection = detail::Point2D::findIntersection(lineSegment, line, intersectionPoint);
 
-                if (foundIntersection) {
-                    shear_mult[i] = std::exp(intersectionPoint.getY());
-                } else {
-                    std::cerr << " failed in finding the solution for shear-thinning multiplier " << std::endl;
-                    return false; // failed in finding the solution.
-                }
-            } else {
-                // check if the failure in finding the shear multiplier is due to too big water velocity.
-                if ((logWaterVelO - logShearVRF.back()) < logShearWaterVel.back()) {
-                    std::cout << " the veclocity is " << water_vel[i] << std::endl;
-                    std::cout << " max shear velocity is " << maxShearVel << std::endl;
-                    std::cerr << " something wrong happend in finding segment" << std::endl;
-                    return false;
+                    if (foundIntersection) {
+                        shear_mult[i] = std::exp(intersectionPoint.getY());
+                    } else {
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+                        std::cerr << " failed in finding the solution for shear-thinning multiplier " << std::endl;
+                        failed = true; // failed in finding the solution.
+                    }
                 } else {
-                    shear_mult[i] = std::exp(logShearVRF.back());
+                    // check if the failure in finding the shear multiplier is due to too big water velocity.
+                    if ((logWaterVelO - logShearVRF.back()) < logShearWaterVel.back()) {
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+                        {
+                            std::cout << " the veclocity is " << water_vel[i] << std::endl;
+                            std::cout << " max shear velocity is " << maxShearVel << std::endl;
+                            std::cerr << " something wrong happend in finding segment" << std::endl;
+                        }
+                        failed = true;
+                    } else {
+                        shear_mult[i] = std::exp(logShearVRF.back());
+                    }
                 }
-            }
 
+            }
         }
 
-        return true;
+        return !failed;
     }
 }
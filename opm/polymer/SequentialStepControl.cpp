@@ -0,0 +1,126 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <config.h>
+
+#include <opm/polymer/SequentialStepControl.hpp>
+#include <opm/core/utility/Units.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+namespace Opm
+{
+
+    SequentialStepControl::SequentialStepControl(const parameter::ParameterGroup& param)
+        : active_(param.getDefault("adaptive_timestepping", false)),
+          target_change_(param.getDefault("timestep.target_saturation_change", 0.1)),
+          max_change_(param.getDefault("timestep.max_saturation_change", 0.3)),
+          restart_factor_(param.getDefault("solver.restartfactor", 0.33)),
+          max_growth_(param.getDefault("solver.maxgrowth", 3.0)),
+          max_restarts_(param.getDefault("solver.maxrestarts", 10)),
+          min_step_(param.getDefault("solver.min_timestep_in_days", 1e-6) * unit::day),
+          suggested_step_(std::numeric_limits<double>::max()),
+          restarts_(0)
+    {
+        errors_[0] = errors_[1] = errors_[2] = 1.0;
+    }
+
+
+
+
+    double SequentialStepControl::nextStep(const double time_left) const
+    {
+        if (!active_ || suggested_step_ >= time_left) {
+            return time_left;
+        }
+        // Two equal substeps rather than a long one and a short remainder.
+        if (1.5 * suggested_step_ > time_left) {
+            return 0.5 * time_left;
+        }
+        return suggested_step_;
+    }
+
+
+
+
+    bool SequentialStepControl::accept(const double saturation_change) const
+    {
+        return !active_ || saturation_change <= max_change_;
+    }
+
+
+
+
+    void SequentialStepControl::stepAccepted(const double dt, const double saturation_change)
+    {
+        restarts_ = 0;
+        if (!active_) {
+            return;
+        }
+        // PID control of the relative saturation change, as in the
+        // PIDTimeStepControl of opm-core.
+        const double tiny = 1e-3;
+        errors_[0] = errors_[1];
+        errors_[1] = errors_[2];
+        errors_[2] = std::max(saturation_change / target_change_, tiny);
+        const double kP = 0.075;
+        const double kI = 0.175;
+        const double kD = 0.01;
+        const double factor = std::pow(errors_[1] / errors_[2], kP)
+            * std::pow(1.0 / errors_[2], kI)
+            * std::pow(errors_[1] * errors_[1] / (errors_[0] * errors_[2]), kD);
+        suggested_step_ = dt * std::min(factor, max_growth_);
+    }
+
+
+
+
+    bool SequentialStepControl::stepFailed(const double dt, const double saturation_change)
+    {
+        if (!active_ || ++restarts_ > max_restarts_) {
+            return false;
+        }
+        // A rejected step is shortened in proportion to its change, a
+        // failed solve (no change known) by the restart factor.
+        double factor = restart_factor_;
+        if (saturation_change > 0.0) {
+            factor = std::max(restart_factor_, std::min(0.9, 0.9 * target_change_ / saturation_change));
+        }
+        suggested_step_ = dt * factor;
+        return suggested_step_ >= min_step_;
+    }
+
+
+
+
+    double SequentialStepControl::saturationChange(const std::vector<double>& s0,
+                                                   const std::vector<double>& s)
+    {
+        assert(s0.size() == s.size());
+        double change = 0.0;
+        for (std::size_t i = 0; i < s.size(); ++i) {
+            change = std::max(change, std::abs(s[i] - s0[i]));
+        }
+        return change;
+    }
+
+} // namespace Opm
@@ -0,0 +1,92 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_SEQUENTIALSTEPCONTROL_HEADER_INCLUDED
+#define OPM_SEQUENTIALSTEPCONTROL_HEADER_INCLUDED
+
+#include <opm/core/utility/parameters/ParameterGroup.hpp>
+
+#include <vector>
+
+namespace Opm
+{
+
+    /// Time step control for the sequential polymer simulators.
+    ///
+    /// A report step is divided into substeps, each with a pressure
+    /// and a transport solve. The length of the next substep is chosen
+    /// by a PID controller from the largest saturation change of the
+    /// last substeps, aiming at a target change. A substep whose change
+    /// exceeds the allowed maximum, or whose solves failed, is repeated
+    /// with a shorter length.
+    ///
+    /// The following parameters are used:
+    ///   adaptive_timestepping             (default false) enable the control
+    ///   timestep.target_saturation_change (default 0.1)   target of the controller
+    ///   timestep.max_saturation_change    (default 0.3)   substeps above are repeated
+    ///   solver.restartfactor              (default 0.33)  reduction of a repeated substep
+    ///   solver.maxgrowth                  (default 3.0)   largest growth between substeps
+    ///   solver.maxrestarts                (default 10)    repetitions of a substep before giving up
+    ///   solver.min_timestep_in_days       (default 1e-6)  shortest substep
+    class SequentialStepControl
+    {
+    public:
+        /// Construct from parameters.
+        explicit SequentialStepControl(const parameter::ParameterGroup& param);
+
+        /// Whether report steps are divided adaptively.
+        bool active() const { return active_; }
+
+        /// Length of the next substep, given the time left of the report step.
+        double nextStep(const double time_left) const;
+
+        /// Whether a substep with the given largest saturation change is accepted.
+        bool accept(const double saturation_change) const;
+
+        /// Record an accepted substep and its largest saturation change,
+        /// and choose the length of the following one.
+        void stepAccepted(const double dt, const double saturation_change);
+
+        /// Record a failed or rejected substep. Returns false if the
+        /// substep may not be repeated (too many repetitions or too
+        /// short a step), in which case the caller should give up.
+        bool stepFailed(const double dt, const double saturation_change);
+
+        /// Largest change of the saturations between two states.
+        static double saturationChange(const std::vector<double>& s0,
+                                       const std::vector<double>& s);
+
+    private:
+        bool active_;
+        double target_change_;
+        double max_change_;
+        double restart_factor_;
+        double max_growth_;
+        int max_restarts_;
+        double min_step_;
+
+        double suggested_step_;
+        int restarts_;
+        // saturation changes of the last three accepted substeps, relative to the target
+        double errors_[3];
+    };
+
+} // namespace Opm
+
+#endif // OPM_SEQUENTIALSTEPCONTROL_HEADER_INCLUDED
@@ -26,6 +26,7 @@
 #include <opm/common/ErrorMacros.hpp>
 
 #include <opm/polymer/CompressibleTpfaPolymer.hpp>
+#include <opm/polymer/InexactNewtonLinearSolver.hpp>
 
 #include <opm/core/grid.h>
 #include <opm/core/wells.h>
@@ -49,6 +50,7 @@
 #include <opm/core/simulator/WellState.hpp>
 #include <opm/polymer/TransportSolverTwophaseCompressiblePolymer.hpp>
 #include <opm/polymer/PolymerInflow.hpp>
+#include <opm/polymer/SequentialStepControl.hpp>
 #include <opm/polymer/PolymerProperties.hpp>
 #include <opm/polymer/polymerUtilities.hpp>
 
@@ -126,8 +128,11 @@ namespace Opm
         const PolymerInflowInterface& polymer_inflow_;
         const double* gravity_;
         // Solvers
+        InexactNewtonLinearSolver pressure_linsolver_;
         CompressibleTpfaPolymer psolver_;
         TransportSolverTwophaseCompressiblePolymer tsolver_;
+        // Division of the report steps into substeps.
+        SequentialStepControl step_control_;
         // Needed by column-based gravity segregation solver.
         std::vector< std::vector<int> > columns_;
         // Misc. data
@@ -183,7 +188,8 @@ namespace Opm
           wells_(wells_manager.c_wells()),
           polymer_inflow_(polymer_inflow),
           gravity_(gravity),
-          psolver_(grid, props, rock_comp_props, poly_props, linsolver,
+          pressure_linsolver_(linsolver),
+          psolver_(grid, props, rock_comp_props, poly_props, pressure_linsolver_,
                    param.getDefault("nl_pressure_residual_tolerance", 0.0),
                    param.getDefault("nl_pressure_change_tolerance", 1.0),
                    param.getDefault("nl_pressure_maxiter", 10),
@@ -191,7 +197,8 @@ namespace Opm
           tsolver_(grid, props, poly_props,
                    TransportSolverTwophaseCompressiblePolymer::Bracketing,
                    param.getDefault("nl_tolerance", 1e-9),
-                   param.getDefault("nl_maxiter", 30))
+                   param.getDefault("nl_maxiter", 30)),
+          step_control_(param)
     {
         // For output.
         output_ = param.getDefault("output", true);
@@ -213,6 +220,10 @@ namespace Opm
         check_well_controls_ = param.getDefault("check_well_controls", false);
         max_well_control_iterations_ = param.getDefault("max_well_control_iterations", 10);
 
+        // Pressure Newton acceleration init.
+        pressure_linsolver_.setForcing(param.getDefault("nl_pressure_forcing_max", 0.0));
+        pressure_linsolver_.setAndersonDepth(param.getDefault("nl_pressure_anderson_depth", 0));
+
         // Transport related init.
         TransportSolverTwophaseCompressiblePolymer::SingleCellMethod method;
         std::string method_string = param.getDefault("single_cell_method", std::string("Bracketing"));
@@ -295,134 +306,191 @@ namespace Opm
             outputStateMatlab(grid_, state, timer.currentStepNum(), output_dir_);
         }
 
-        initial_pressure = state.pressure();
-
-        // Solve pressure equation.
-        if (check_well_controls_) {
-            computeFractionalFlow(props_, poly_props_, allcells_,
-                                  state.pressure(), state.temperature(), state.surfacevol(), state.saturation(),
-                                  state.concentration(), state.maxconcentration(),
-                                  fractional_flows);
-            wells_manager_.applyExplicitReinjectionControls(well_resflows_phase, well_resflows_phase);
-        }
-        bool well_control_passed = !check_well_controls_;
-        int well_control_iteration = 0;
-        do {
-            // Run solver
-            pressure_timer.start();
-            psolver_.solve(timer.currentStepLength(), state, well_state);
-
-            // Renormalize pressure if both fluids and rock are
-            // incompressible, and there are no pressure
-            // conditions (bcs or wells).  It is deemed sufficient
-            // for now to renormalize using geometric volume
-            // instead of pore volume.
-            if (psolver_.singularPressure()) {
-                // Compute average pressures of previous and last
-                // step, and total volume.
-                double av_prev_press = 0.0;
-                double av_press = 0.0;
-                double tot_vol = 0.0;
-                const int num_cells = grid_.number_of_cells;
-                for (int cell = 0; cell < num_cells; ++cell) {
-                    av_prev_press += initial_pressure[cell]*grid_.cell_volumes[cell];
-                    av_press      += state.pressure()[cell]*grid_.cell_volumes[cell];
-                    tot_vol       += grid_.cell_volumes[cell];
-                }
-                // Renormalization constant
-                const double ren_const = (av_prev_press - av_press)/tot_vol;
-                for (int cell = 0; cell < num_cells; ++cell) {
-                    state.pressure()[cell] += ren_const;
+        // The report step is solved in one or, with adaptive time
+        // stepping, several substeps of pressure and transport.
+        const double report_end = timer.simulationTimeElapsed() + timer.currentStepLength();
+        double current_time = timer.simulationTimeElapsed();
+        double injected[2] = { 0.0 };
+        double produced[2] = { 0.0 };
+        double polyinj = 0.0;
+        double polyprod = 0.0;
+        while (current_time < report_end) {
+            const double time_left = report_end - current_time;
+            const double dt = step_control_.nextStep(time_left);
+            // Start of the substep, to repeat it if it is not accepted.
+            PolymerBlackoilState state0;
+            WellState well_state0;
+            std::vector<double> porevol0;
+            if (step_control_.active()) {
+                state0 = state;
+                well_state0 = well_state;
+                porevol0 = porevol;
+            }
+            double step_injected[2] = { 0.0 };
+            double step_produced[2] = { 0.0 };
+            double step_polyinj = 0.0;
+            double step_polyprod = 0.0;
+            bool solved = true;
+            try {
+                initial_pressure = state.pressure();
+
+                // Solve pressure equation.
+                if (check_well_controls_) {
+                    computeFractionalFlow(props_, poly_props_, allcells_,
+                                          state.pressure(), state.temperature(), state.surfacevol(), state.saturation(),
+                                          state.concentration(), state.maxconcentration(),
+                                          fractional_flows);
+                    wells_manager_.applyExplicitReinjectionControls(well_resflows_phase, well_resflows_phase);
                 }
-                const int num_wells = (wells_ == NULL) ? 0 : wells_->number_of_wells;
-                for (int well = 0; well < num_wells; ++well) {
-                    well_state.bhp()[well] += ren_const;
+                bool well_control_passed = !check_well_controls_;
+                int well_control_iteration = 0;
+                do {
+                    // Run solver
+                    pressure_timer.start();
+                    pressure_linsolver_.beginNewton();
+                    psolver_.solve(dt, state, well_state);
+
+                    // Renormalize pressure if both fluids and rock are
+                    // incompressible, and there are no pressure
+                    // conditions (bcs or wells).  It is deemed sufficient
+                    // for now to renormalize using geometric volume
+                    // instead of pore volume.
+                    if (psolver_.singularPressure()) {
+                        // Compute average pressures of previous and last
+                        // step, and total volume.
+                        double av_prev_press = 0.0;
+                        double av_press = 0.0;
+                        double tot_vol = 0.0;
+                        const int num_cells = grid_.number_of_cells;
+                        for (int cell = 0; cell < num_cells; ++cell) {
+                            av_prev_press += initial_pressure[cell]*grid_.cell_volumes[cell];
+                            av_press      += state.pressure()[cell]*grid_.cell_volumes[cell];
+                            tot_vol       += grid_.cell_volumes[cell];
+                        }
+                        // Renormalization constant
+                        const double ren_const = (av_prev_press - av_press)/tot_vol;
+                        for (int cell = 0; cell < num_cells; ++cell) {
+                            state.pressure()[cell] += ren_const;
+                        }
+                        const int num_wells = (wells_ == NULL) ? 0 : wells_->number_of_wells;
+                        for (int well = 0; well < num_wells; ++well) {
+                            well_state.bhp()[well] += ren_const;
+                        }
+                    }
+
+                    // Stop timer and report
+                    pressure_timer.stop();
+                    double pt = pressure_timer.secsSinceStart();
+                    std::cout << "Pressure solver took:  " << pt << " seconds." << std::endl;
+                    ptime += pt;
+
+                    // Optionally, check if well controls are satisfied.
+                    if (check_well_controls_) {
+                        Opm::computePhaseFlowRatesPerWell(*wells_,
+                                                          well_state.perfRates(),
+                                                          fractional_flows,
+                                                          well_resflows_phase);
+                        std::cout << "Checking well conditions." << std::endl;
+                        // For testing we set surface := reservoir
+                        well_control_passed = wells_manager_.conditionsMet(well_state.bhp(), well_resflows_phase, well_resflows_phase);
+                        ++well_control_iteration;
+                        if (!well_control_passed && well_control_iteration > max_well_control_iterations_) {
+                            OPM_THROW(std::runtime_error, "Could not satisfy well conditions in " << max_well_control_iterations_ << " tries.");
+                        }
+                        if (!well_control_passed) {
+                            std::cout << "Well controls not passed, solving again." << std::endl;
+                        } else {
+                            std::cout << "Well conditions met." << std::endl;
+                        }
+                    }
+                } while (!well_control_passed);
+
+                // Update pore volumes if rock is compressible.
+                if (rock_comp_props_ && rock_comp_props_->isActive()) {
+                    initial_porevol = porevol;
+                    computePorevolume(grid_, props_.porosity(), *rock_comp_props_, state.pressure(), porevol);
                 }
-            }
 
-            // Stop timer and report
-            pressure_timer.stop();
-            double pt = pressure_timer.secsSinceStart();
-            std::cout << "Pressure solver took:  " << pt << " seconds." << std::endl;
-            ptime += pt;
-
-            // Optionally, check if well controls are satisfied.
-            if (check_well_controls_) {
-                Opm::computePhaseFlowRatesPerWell(*wells_,
-                                                  well_state.perfRates(),
-                                                  fractional_flows,
-                                                  well_resflows_phase);
-                std::cout << "Checking well conditions." << std::endl;
-                // For testing we set surface := reservoir
-                well_control_passed = wells_manager_.conditionsMet(well_state.bhp(), well_resflows_phase, well_resflows_phase);
-                ++well_control_iteration;
-                if (!well_control_passed && well_control_iteration > max_well_control_iterations_) {
-                    OPM_THROW(std::runtime_error, "Could not satisfy well conditions in " << max_well_control_iterations_ << " tries.");
+                // Process transport sources (to include bdy terms and well flows).
+                Opm::computeTransportSource(props_, wells_, well_state, transport_src);
+
+                // Solve transport.
+                transport_timer.start();
+                double stepsize = dt;
+                if (num_transport_substeps_ != 1) {
+                    stepsize /= double(num_transport_substeps_);
+                    std::cout << "Making " << num_transport_substeps_ << " transport substeps." << std::endl;
+                }
+                for (int tr_substep = 0; tr_substep < num_transport_substeps_; ++tr_substep) {
+                    // Inflow averaged over the substep, so that injection varying
+                    // in time is resolved within the step.
+                    const double substep_start = current_time + tr_substep*stepsize;
+                    polymer_inflow_.getInflowValues(substep_start, substep_start + stepsize, polymer_inflow_c);
+                    tsolver_.solve(&state.faceflux()[0], initial_pressure,
+                                   state.pressure(), state.temperature(), &initial_porevol[0], &porevol[0],
+                                   &transport_src[0], &polymer_inflow_c[0], stepsize,
+                                   state.saturation(), state.surfacevol(),
+                                   state.concentration(), state.maxconcentration());
+                    double substep_injected[2] = { 0.0 };
+                    double substep_produced[2] = { 0.0 };
+                    double substep_polyinj = 0.0;
+                    double substep_polyprod = 0.0;
+                    Opm::computeInjectedProduced(props_, poly_props_,
+                                                 state,
+                                                 transport_src, polymer_inflow_c, stepsize,
+                                                 substep_injected, substep_produced,
+                                                 substep_polyinj, substep_polyprod);
+                    step_injected[0] += substep_injected[0];
+                    step_injected[1] += substep_injected[1];
+                    step_produced[0] += substep_produced[0];
+                    step_produced[1] += substep_produced[1];
+                    step_polyinj += substep_polyinj;
+                    step_polyprod += substep_polyprod;
+                    if (gravity_ != 0 && use_segregation_split_) {
+                        tsolver_.solveGravity(columns_, stepsize,
+                                              state.saturation(), state.surfacevol(),
+                                              state.concentration(), state.maxconcentration());
+                    }
                 }
-                if (!well_control_passed) {
-                    std::cout << "Well controls not passed, solving again." << std::endl;
-                } else {
-                    std::cout << "Well conditions met." << std::endl;
+                transport_timer.stop();
+                double tt = transport_timer.secsSinceStart();
+                std::cout << "Transport solver took: " << tt << " seconds." << std::endl;
+                ttime += tt;
+            } catch (const std::runtime_error& e) {
+                if (!step_control_.active()) {
+                    throw;
                 }
+                std::cout << "Substep of " << unit::convert::to(dt, unit::day)
+                          << " days failed: " << e.what() << std::endl;
+                solved = false;
             }
-        } while (!well_control_passed);
 
-        // Update pore volumes if rock is compressible.
-        if (rock_comp_props_ && rock_comp_props_->isActive()) {
-            initial_porevol = porevol;
-            computePorevolume(grid_, props_.porosity(), *rock_comp_props_, state.pressure(), porevol);
-        }
-
-        // Process transport sources (to include bdy terms and well flows).
-        Opm::computeTransportSource(props_, wells_, well_state, transport_src);
-
-        // Find inflow rate.
-        const double current_time = timer.simulationTimeElapsed();
-        double stepsize = timer.currentStepLength();
-        polymer_inflow_.getInflowValues(current_time, current_time + stepsize, polymer_inflow_c);
-
-
-        // Solve transport.
-        transport_timer.start();
-        if (num_transport_substeps_ != 1) {
-            stepsize /= double(num_transport_substeps_);
-            std::cout << "Making " << num_transport_substeps_ << " transport substeps." << std::endl;
-        }
-        double injected[2] = { 0.0 };
-        double produced[2] = { 0.0 };
-        double polyinj = 0.0;
-        double polyprod = 0.0;
-        for (int tr_substep = 0; tr_substep < num_transport_substeps_; ++tr_substep) {
-            tsolver_.solve(&state.faceflux()[0], initial_pressure,
-                           state.pressure(), state.temperature(), &initial_porevol[0], &porevol[0],
-                           &transport_src[0], &polymer_inflow_c[0], stepsize,
-                           state.saturation(), state.surfacevol(),
-                           state.concentration(), state.maxconcentration());
-            double substep_injected[2] = { 0.0 };
-            double substep_produced[2] = { 0.0 };
-            double substep_polyinj = 0.0;
-            double substep_polyprod = 0.0;
-            Opm::computeInjectedProduced(props_, poly_props_,
-                                         state,
-                                         transport_src, polymer_inflow_c, stepsize,
-                                         substep_injected, substep_produced,
-                                         substep_polyinj, substep_polyprod);
-            injected[0] += substep_injected[0];
-            injected[1] += substep_injected[1];
-            produced[0] += substep_produced[0];
-            produced[1] += substep_produced[1];
-            polyinj += substep_polyinj;
-            polyprod += substep_polyprod;
-            if (gravity_ != 0 && use_segregation_split_) {
-                tsolver_.solveGravity(columns_, stepsize,
-                                      state.saturation(), state.surfacevol(),
-                                      state.concentration(), state.maxconcentration());
+            // Accept the substep, or repeat it with a shorter length.
+            if (step_control_.active()) {
+                const double change = solved
+                    ? SequentialStepControl::saturationChange(state0.saturation(), state.saturation())
+                    : 0.0;
+                if (!solved || !step_control_.accept(change)) {
+                    if (!step_control_.stepFailed(dt, change)) {
+                        OPM_THROW(std::runtime_error, "Could not solve the substep starting at "
+                                  << unit::convert::to(current_time, unit::day) << " days.");
+                    }
+                    std::cout << "Repeating substep with a shorter time step." << std::endl;
+                    state = state0;
+                    well_state = well_state0;
+                    porevol = porevol0;
+                    continue;
+                }
+                step_control_.stepAccepted(dt, change);
             }
+            injected[0] += step_injected[0];
+            injected[1] += step_injected[1];
+            produced[0] += step_produced[0];
+            produced[1] += step_produced[1];
+            polyinj += step_polyinj;
+            polyprod += step_polyprod;
+            current_time = (dt < time_left) ? current_time + dt : report_end;
         }
-        transport_timer.stop();
-        double tt = transport_timer.secsSinceStart();
-        std::cout << "Transport solver took: " << tt << " seconds." << std::endl;
-        ttime += tt;
 
         // Report volume balances.
         Opm::computeSaturatedVol(porevol, state.surfacevol(), inplace_surfvol);
@@ -55,6 +55,10 @@ namespace Opm
         ///     nl_pressure_residual_tolerance (0.0) pressure solver residual tolerance (in Pascal)
         ///     nl_pressure_change_tolerance (1.0)   pressure solver change tolerance (in Pascal)
         ///     nl_pressure_maxiter (10)       max nonlinear iterations in pressure
+        ///     nl_pressure_forcing_max (0.0)  if positive, loosest linear tolerance of the
+        ///                                    inexact Newton forcing term in pressure
+        ///     nl_pressure_anderson_depth (0) depth of Anderson acceleration of the
+        ///                                    pressure Newton iterations (0 = off)
         ///     nl_maxiter (30)                max nonlinear iterations in transport
         ///     nl_tolerance (1e-9)            transport solver absolute residual tolerance
         ///     num_transport_substeps (1)     number of transport steps per pressure step
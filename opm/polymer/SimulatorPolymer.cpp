@@ -26,7 +26,9 @@
 #include <opm/core/utility/parameters/ParameterGroup.hpp>
 #include <opm/common/ErrorMacros.hpp>
 
+#include <opm/polymer/BackgroundTaskQueue.hpp>
 #include <opm/polymer/IncompTpfaPolymer.hpp>
+#include <opm/polymer/IncrementalLinearSolver.hpp>
 
 #include <opm/core/grid.h>
 #include <opm/core/wells.h>
@@ -50,6 +52,7 @@
 #include <opm/core/simulator/WellState.hpp>
 #include <opm/polymer/TransportSolverTwophasePolymer.hpp>
 #include <opm/polymer/PolymerInflow.hpp>
+#include <opm/polymer/SequentialStepControl.hpp>
 #include <opm/polymer/PolymerProperties.hpp>
 #include <opm/polymer/polymerUtilities.hpp>
 
@@ -60,6 +63,8 @@
 #include <numeric>
 #include <fstream>
 #include <iostream>
+#include <sstream>
+#include <memory>
 
 #ifdef HAVE_ERT
 #include <opm/core/io/eclipse/writeECLData.hpp>
@@ -92,6 +97,55 @@ namespace Opm
         bool allNeumannBCs(const FlowBoundaryConditions* bcs);
         bool allRateWells(const Wells* wells);
 
+        // Output settings and the observed objects the output and the
+        // balance report need. Output tasks hold a copy, they may run
+        // after the simulator of their report step is gone.
+        struct OutputContext
+        {
+            const UnstructuredGrid* grid;
+            const IncompPropertiesInterface* props;
+            const PolymerProperties* poly_props;
+            bool output_vtk;
+            bool output_binary;
+            std::string output_dir;
+        };
+
+        // Everything the balance report and the output at the end of a
+        // report step are computed from, copied from the simulation.
+        struct StepReport
+        {
+            SimulatorTimer timer;
+            bool report_balance;
+            bool write_output;
+            // Total pore volume at the start of the step, for scaling.
+            double tot_porevol_init;
+            // Pore volume and state at the start of the step, for the
+            // balance report only.
+            std::vector<double> init_porevol;
+            std::vector<double> init_saturation;
+            std::vector<double> init_concentration;
+            std::vector<double> init_maxconcentration;
+            // Source cells after every accepted transport substep.
+            std::vector<SourceCellsSnapshot> sources;
+            // Pore volume and state at the end of the step.
+            std::vector<double> porevol;
+            PolymerState state;
+            WellReport wellreport;
+            bool has_wells;
+        };
+
+        // Write state, and optionally water cut and well report, to disk.
+        void writeState(const OutputContext& context,
+                        const SimulatorTimer& timer,
+                        const PolymerState& state,
+                        const Watercut* watercut,
+                        const WellReport* wellreport);
+        // Report volume and polymer mass balance to a stream and write
+        // the output of the end of a report step.
+        void reportStep(const OutputContext& context,
+                        const StepReport& report,
+                        std::ostream& os);
+
     } // anonymous namespace
 
 
@@ -109,13 +163,24 @@ namespace Opm
              const std::vector<double>& src,
              const FlowBoundaryConditions* bcs,
              LinearSolverInterface& linsolver,
-             const double* gravity);
+             const double* gravity,
+             BackgroundTaskQueue* output_queue);
 
         SimulatorReport run(SimulatorTimer& timer,
                             PolymerState& state,
                             WellState& well_state);
 
     private:
+        // Write the state to disk. With asynchronous output, a snapshot
+        // is written by the output thread.
+        void outputState(const SimulatorTimer& timer,
+                         const PolymerState& state);
+        // Balance report and output of the end of a report step, on the
+        // output thread with asynchronous output. The report is then
+        // printed by this thread, before the next step or after wait().
+        void finishStep(const std::shared_ptr<StepReport>& report);
+        OutputContext outputContext() const;
+
         // Data.
 
         // Parameters for output.
@@ -124,6 +189,7 @@ namespace Opm
         bool output_binary_;
         std::string output_dir_;
         int output_interval_;
+        int balance_report_interval_;
         // Parameters for well control
         bool check_well_controls_;
         int max_well_control_iterations_;
@@ -141,12 +207,19 @@ namespace Opm
         const std::vector<double>& src_;
         const FlowBoundaryConditions* bcs_;
         // Solvers
+        IncrementalLinearSolver pressure_linsolver_;
         IncompTpfaPolymer psolver_;
         TransportSolverTwophasePolymer tsolver_;
+        // Division of the report steps into substeps.
+        SequentialStepControl step_control_;
         // Needed by column-based gravity segregation solver.
         std::vector< std::vector<int> > columns_;
         // Misc. data
         std::vector<int> allcells_;
+        // Output thread, either given or owned. The own queue is drained
+        // at the end of every run(), a given one by its owner.
+        BackgroundTaskQueue* output_queue_;
+        boost::scoped_ptr<BackgroundTaskQueue> own_output_queue_;
     };
 
 
@@ -162,10 +235,12 @@ namespace Opm
                                        const std::vector<double>& src,
                                        const FlowBoundaryConditions* bcs,
                                        LinearSolverInterface& linsolver,
-                                       const double* gravity)
+                                       const double* gravity,
+                                       BackgroundTaskQueue* output_queue)
     {
         pimpl_.reset(new Impl(param, grid, props, poly_props, rock_comp_props,
-                              wells_manager, polymer_inflow, src, bcs, linsolver, gravity));
+                              wells_manager, polymer_inflow, src, bcs, linsolver, gravity,
+                              output_queue));
     }
 
 
@@ -193,7 +268,8 @@ namespace Opm
                                  const std::vector<double>& src,
                                  const FlowBoundaryConditions* bcs,
                                  LinearSolverInterface& linsolver,
-                                 const double* gravity)
+                                 const double* gravity,
+                                 BackgroundTaskQueue* output_queue)
         : grid_(grid),
           props_(props),
           poly_props_(poly_props),
@@ -203,14 +279,20 @@ namespace Opm
           polymer_inflow_(polymer_inflow),
           src_(src),
           bcs_(bcs),
-          psolver_(grid, props, rock_comp_props, poly_props, linsolver,
+          pressure_linsolver_(linsolver),
+          psolver_(grid, props, rock_comp_props, poly_props,
+                   (param.getDefault("pressure_warm_start", true)
+                    || param.getDefault("well_control_schur", false))
+                   ? static_cast<LinearSolverInterface&>(pressure_linsolver_) : linsolver,
                    param.getDefault("nl_pressure_residual_tolerance", 0.0),
                    param.getDefault("nl_pressure_change_tolerance", 1.0),
                    param.getDefault("nl_pressure_maxiter", 10),
                    gravity, wells_manager.c_wells(), src, bcs),
           tsolver_(grid, props, poly_props, TransportSolverTwophasePolymer::Bracketing,
                    param.getDefault("nl_tolerance", 1e-9),
-                   param.getDefault("nl_maxiter", 30))
+                   param.getDefault("nl_maxiter", 30)),
+          step_control_(param),
+          output_queue_(output_queue)
     {
         // For output.
         output_ = param.getDefault("output", true);
@@ -232,12 +314,25 @@ namespace Opm
                 OPM_THROW(std::runtime_error, "Creating directories failed: " << fpath);
             }
             output_interval_ = param.getDefault("output_interval", 1);
+            if (!output_queue_ && param.getDefault("output_async", false)) {
+                own_output_queue_.reset(new BackgroundTaskQueue(param.getDefault("output_queue_size", 2)));
+                output_queue_ = own_output_queue_.get();
+            }
         }
 
+        balance_report_interval_ = param.getDefault("balance_report_interval", 1);
+
         // Well control related init.
         check_well_controls_ = param.getDefault("check_well_controls", false);
         max_well_control_iterations_ = param.getDefault("max_well_control_iterations", 10);
 
+        // Pressure linear solver init.
+        pressure_linsolver_.setWarmStart(param.getDefault("pressure_warm_start", true));
+        if (wells_ && param.getDefault("well_control_schur", false)) {
+            pressure_linsolver_.setWellSchurComplement(grid.number_of_cells,
+                                                       param.getDefault("well_control_schur_max_wells", 100));
+        }
+
         // Transport related init.
         TransportSolverTwophasePolymer::SingleCellMethod method;
         std::string method_string = param.getDefault("single_cell_method", std::string("Bracketing"));
@@ -280,7 +375,6 @@ namespace Opm
         } else {
             computePorevolume(grid_, props_.porosity(), porevol);
         }
-        const double tot_porevol_init = std::accumulate(porevol.begin(), porevol.end(), 0.0);
         std::vector<double> initial_porevol = porevol;
 
         // Main simulation loop.
@@ -290,232 +384,214 @@ namespace Opm
         double ttime = 0.0;
         Opm::time::StopWatch total_timer;
         total_timer.start();
-        double init_satvol[2] = { 0.0 };
-        double satvol[2] = { 0.0 };
-        double polymass = computePolymerMass(porevol, state.saturation(), state.concentration(), poly_props_.deadPoreVol());
-        double polymass_adsorbed = computePolymerAdsorbed(props_, poly_props_, porevol, state.maxconcentration());
-        double init_polymass = polymass + polymass_adsorbed;
-        double injected[2] = { 0.0 };
-        double produced[2] = { 0.0 };
-        double polyinj = 0.0;
-        double polyprod = 0.0;
-        double tot_injected[2] = { 0.0 };
-        double tot_produced[2] = { 0.0 };
-        double tot_polyinj = 0.0;
-        double tot_polyprod = 0.0;
-        Opm::computeSaturatedVol(porevol, state.saturation(), init_satvol);
-        std::cout << "\nInitial saturations are    " << init_satvol[0]/tot_porevol_init
-                  << "    " << init_satvol[1]/tot_porevol_init << std::endl;
-        Opm::Watercut watercut;
-        watercut.push(0.0, 0.0, 0.0);
-        Opm::WellReport wellreport;
+
+        // Inputs of the balance report and output of this step.
+        std::shared_ptr<StepReport> step_report(new StepReport());
+        step_report->timer = timer;
+        step_report->report_balance = balance_report_interval_ > 0
+            && (timer.currentStepNum() % balance_report_interval_ == 0);
+        step_report->write_output = output_;
+        step_report->has_wells = (wells_ != 0);
+        step_report->tot_porevol_init = std::accumulate(porevol.begin(), porevol.end(), 0.0);
+        const bool need_report = step_report->report_balance || step_report->write_output;
+        if (step_report->report_balance) {
+            step_report->init_porevol = porevol;
+            step_report->init_saturation = state.saturation();
+            step_report->init_concentration = state.concentration();
+            step_report->init_maxconcentration = state.maxconcentration();
+        }
         std::vector<double> fractional_flows;
         std::vector<double> well_resflows_phase;
         if (wells_) {
             well_resflows_phase.resize((wells_->number_of_phases)*(wells_->number_of_wells), 0.0);
-            wellreport.push(props_, *wells_, state.saturation(), 0.0, well_state.bhp(), well_state.perfRates());
+            step_report->wellreport.push(props_, *wells_, state.saturation(), 0.0, well_state.bhp(), well_state.perfRates());
+        }
+        // Balance reports of earlier steps finished by the output thread.
+        if (output_queue_) {
+            output_queue_->printMessages(std::cout);
         }
         // Report timestep and (optionally) write state to disk.
         timer.report(std::cout);
         if (output_ && (timer.currentStepNum() % output_interval_ == 0)) {
-            if (output_vtk_) {
-                outputStateVtk(grid_, state, timer.currentStepNum(), output_dir_);
-            }
-            if (output_binary_) {
-                outputStateBinary(grid_, state, timer, output_dir_);
-            }
-            outputStateMatlab(grid_, state, timer.currentStepNum(), output_dir_);
+            outputState(timer, state);
         }
 
-        // Solve pressure.
-        if (check_well_controls_) {
-            computeFractionalFlow(props_, poly_props_, allcells_,
-                                  state.saturation(), state.concentration(), state.maxconcentration(),
-                                  fractional_flows);
-            wells_manager_.applyExplicitReinjectionControls(well_resflows_phase, well_resflows_phase);
-        }
-        bool well_control_passed = !check_well_controls_;
-        int well_control_iteration = 0;
-        do {
-            // Run solver.
-            pressure_timer.start();
-            std::vector<double> initial_pressure = state.pressure();
-            psolver_.solve(timer.currentStepLength(), state, well_state);
-
-            // Renormalize pressure if rock is incompressible, and
-            // there are no pressure conditions (bcs or wells).
-            // It is deemed sufficient for now to renormalize
-            // using geometric volume instead of pore volume.
-            if ((rock_comp_props_ == NULL || !rock_comp_props_->isActive())
-                && allNeumannBCs(bcs_) && allRateWells(wells_)) {
-                // Compute average pressures of previous and last
-                // step, and total volume.
-                double av_prev_press = 0.0;
-                double av_press = 0.0;
-                double tot_vol = 0.0;
-                const int num_cells = grid_.number_of_cells;
-                for (int cell = 0; cell < num_cells; ++cell) {
-                    av_prev_press += initial_pressure[cell]*grid_.cell_volumes[cell];
-                    av_press      += state.pressure()[cell]*grid_.cell_volumes[cell];
-                    tot_vol       += grid_.cell_volumes[cell];
-                }
-                // Renormalization constant
-                const double ren_const = (av_prev_press - av_press)/tot_vol;
-                for (int cell = 0; cell < num_cells; ++cell) {
-                    state.pressure()[cell] += ren_const;
+        // The report step is solved in one or, with adaptive time
+        // stepping, several substeps of pressure and transport.
+        const double report_end = timer.simulationTimeElapsed() + timer.currentStepLength();
+        double current_time = timer.simulationTimeElapsed();
+        while (current_time < report_end) {
+            const double time_left = report_end - current_time;
+            const double dt = step_control_.nextStep(time_left);
+            // Start of the substep, to repeat it if it is not accepted.
+            PolymerState state0;
+            WellState well_state0;
+            std::vector<double> porevol0;
+            if (step_control_.active()) {
+                state0 = state;
+                well_state0 = well_state;
+                porevol0 = porevol;
+            }
+            std::vector<SourceCellsSnapshot> step_sources;
+            bool solved = true;
+            try {
+                // Solve pressure.
+                if (check_well_controls_) {
+                    computeFractionalFlow(props_, poly_props_, allcells_,
+                                          state.saturation(), state.concentration(), state.maxconcentration(),
+                                          fractional_flows);
+                    wells_manager_.applyExplicitReinjectionControls(well_resflows_phase, well_resflows_phase);
                 }
-                const int num_wells = (wells_ == NULL) ? 0 : wells_->number_of_wells;
-                for (int well = 0; well < num_wells; ++well) {
-                    well_state.bhp()[well] += ren_const;
+                bool well_control_passed = !check_well_controls_;
+                int well_control_iteration = 0;
+                do {
+                    // Run solver.
+                    pressure_timer.start();
+                    std::vector<double> initial_pressure = state.pressure();
+                    psolver_.solve(dt, state, well_state);
+
+                    // Renormalize pressure if rock is incompressible, and
+                    // there are no pressure conditions (bcs or wells).
+                    // It is deemed sufficient for now to renormalize
+                    // using geometric volume instead of pore volume.
+                    if ((rock_comp_props_ == NULL || !rock_comp_props_->isActive())
+                        && allNeumannBCs(bcs_) && allRateWells(wells_)) {
+                        // Compute average pressures of previous and last
+                        // step, and total volume.
+                        double av_prev_press = 0.0;
+                        double av_press = 0.0;
+                        double tot_vol = 0.0;
+                        const int num_cells = grid_.number_of_cells;
+                        for (int cell = 0; cell < num_cells; ++cell) {
+                            av_prev_press += initial_pressure[cell]*grid_.cell_volumes[cell];
+                            av_press      += state.pressure()[cell]*grid_.cell_volumes[cell];
+                            tot_vol       += grid_.cell_volumes[cell];
+                        }
+                        // Renormalization constant
+                        const double ren_const = (av_prev_press - av_press)/tot_vol;
+                        for (int cell = 0; cell < num_cells; ++cell) {
+                            state.pressure()[cell] += ren_const;
+                        }
+                        const int num_wells = (wells_ == NULL) ? 0 : wells_->number_of_wells;
+                        for (int well = 0; well < num_wells; ++well) {
+                            well_state.bhp()[well] += ren_const;
+                        }
+                    }
+
+                    // Stop timer and report.
+                    pressure_timer.stop();
+                    double pt = pressure_timer.secsSinceStart();
+                    std::cout << "Pressure solver took:  " << pt << " seconds." << std::endl;
+                    ptime += pt;
+
+                    // Optionally, check if well controls are satisfied.
+                    if (check_well_controls_) {
+                        Opm::computePhaseFlowRatesPerWell(*wells_,
+                                                          well_state.perfRates(),
+                                                          fractional_flows,
+                                                          well_resflows_phase);
+                        std::cout << "Checking well conditions." << std::endl;
+                        // For testing we set surface := reservoir
+                        well_control_passed = wells_manager_.conditionsMet(well_state.bhp(), well_resflows_phase, well_resflows_phase);
+                        ++well_control_iteration;
+                        if (!well_control_passed && well_control_iteration > max_well_control_iterations_) {
+                            OPM_THROW(std::runtime_error, "Could not satisfy well conditions in " << max_well_control_iterations_ << " tries.");
+                        }
+                        if (!well_control_passed) {
+                            std::cout << "Well controls not passed, solving again." << std::endl;
+                        } else {
+                            std::cout << "Well conditions met." << std::endl;
+                        }
+                    }
+                } while (!well_control_passed);
+
+                // Update pore volumes if rock is compressible.
+                if (rock_comp_props_ && rock_comp_props_->isActive()) {
+                    initial_porevol = porevol;
+                    computePorevolume(grid_, props_.porosity(), *rock_comp_props_, state.pressure(), porevol);
                 }
-            }
 
-            // Stop timer and report.
-            pressure_timer.stop();
-            double pt = pressure_timer.secsSinceStart();
-            std::cout << "Pressure solver took:  " << pt << " seconds." << std::endl;
-            ptime += pt;
-
-            // Optionally, check if well controls are satisfied.
-            if (check_well_controls_) {
-                Opm::computePhaseFlowRatesPerWell(*wells_,
-                                                  well_state.perfRates(),
-                                                  fractional_flows,
-                                                  well_resflows_phase);
-                std::cout << "Checking well conditions." << std::endl;
-                // For testing we set surface := reservoir
-                well_control_passed = wells_manager_.conditionsMet(well_state.bhp(), well_resflows_phase, well_resflows_phase);
-                ++well_control_iteration;
-                if (!well_control_passed && well_control_iteration > max_well_control_iterations_) {
-                    OPM_THROW(std::runtime_error, "Could not satisfy well conditions in " << max_well_control_iterations_ << " tries.");
+                // Process transport sources (to include bdy terms and well flows).
+                Opm::computeTransportSource(grid_, src_, state.faceflux(), 1.0,
+                                            wells_, well_state.perfRates(), transport_src);
+
+                // Solve transport.
+                transport_timer.start();
+                double stepsize = dt;
+                if (num_transport_substeps_ != 1) {
+                    stepsize /= double(num_transport_substeps_);
+                    std::cout << "Making " << num_transport_substeps_ << " transport substeps." << std::endl;
+                }
+                for (int tr_substep = 0; tr_substep < num_transport_substeps_; ++tr_substep) {
+                    // Inflow averaged over the substep, so that injection varying
+                    // in time is resolved within the step.
+                    const double substep_start = current_time + tr_substep*stepsize;
+                    polymer_inflow_.getInflowValues(substep_start, substep_start + stepsize, polymer_inflow_c);
+                    tsolver_.solve(&state.faceflux()[0], &initial_porevol[0], &transport_src[0], &polymer_inflow_c[0], stepsize,
+                                   state.saturation(), state.concentration(), state.maxconcentration());
+                    if (need_report) {
+                        // The injected and produced volumes are computed
+                        // by the balance report, from the source cells.
+                        step_sources.push_back(SourceCellsSnapshot());
+                        snapshotSourceCells(state, transport_src, polymer_inflow_c, stepsize,
+                                            step_sources.back());
+                    }
+                    if (use_segregation_split_) {
+                        tsolver_.solveGravity(columns_, &porevol[0], stepsize,
+                                              state.saturation(), state.concentration(), state.maxconcentration());
+                    }
                 }
-                if (!well_control_passed) {
-                    std::cout << "Well controls not passed, solving again." << std::endl;
-                } else {
-                    std::cout << "Well conditions met." << std::endl;
+                transport_timer.stop();
+                double tt = transport_timer.secsSinceStart();
+                std::cout << "Transport solver took: " << tt << " seconds." << std::endl;
+                ttime += tt;
+            } catch (const std::runtime_error& e) {
+                if (!step_control_.active()) {
+                    throw;
                 }
+                std::cout << "Substep of " << unit::convert::to(dt, unit::day)
+                          << " days failed: " << e.what() << std::endl;
+                solved = false;
             }
-        } while (!well_control_passed);
-
-        // Update pore volumes if rock is compressible.
-        if (rock_comp_props_ && rock_comp_props_->isActive()) {
-            initial_porevol = porevol;
-            computePorevolume(grid_, props_.porosity(), *rock_comp_props_, state.pressure(), porevol);
-        }
-
-        // Process transport sources (to include bdy terms and well flows).
-        Opm::computeTransportSource(grid_, src_, state.faceflux(), 1.0,
-                                    wells_, well_state.perfRates(), transport_src);
-
-        // Find inflow rate.
-        const double current_time = timer.simulationTimeElapsed();
-        double stepsize = timer.currentStepLength();
-        polymer_inflow_.getInflowValues(current_time, current_time + stepsize, polymer_inflow_c);
 
-        // Solve transport.
-        transport_timer.start();
-        if (num_transport_substeps_ != 1) {
-            stepsize /= double(num_transport_substeps_);
-            std::cout << "Making " << num_transport_substeps_ << " transport substeps." << std::endl;
-        }
-        double substep_injected[2] = { 0.0 };
-        double substep_produced[2] = { 0.0 };
-        double substep_polyinj = 0.0;
-        double substep_polyprod = 0.0;
-        injected[0] = injected[1] = produced[0] = produced[1] = polyinj = polyprod = 0.0;
-        for (int tr_substep = 0; tr_substep < num_transport_substeps_; ++tr_substep) {
-            tsolver_.solve(&state.faceflux()[0], &initial_porevol[0], &transport_src[0], &polymer_inflow_c[0], stepsize,
-                           state.saturation(), state.concentration(), state.maxconcentration());
-            Opm::computeInjectedProduced(props_, poly_props_,
-                                         state,
-                                         transport_src, polymer_inflow_c, stepsize,
-                                         substep_injected, substep_produced, substep_polyinj, substep_polyprod);
-            injected[0] += substep_injected[0];
-            injected[1] += substep_injected[1];
-            produced[0] += substep_produced[0];
-            produced[1] += substep_produced[1];
-            polyinj += substep_polyinj;
-            polyprod += substep_polyprod;
-            if (use_segregation_split_) {
-                tsolver_.solveGravity(columns_, &porevol[0], stepsize,
-                                      state.saturation(), state.concentration(), state.maxconcentration());
+            // Accept the substep, or repeat it with a shorter length.
+            if (step_control_.active()) {
+                const double change = solved
+                    ? SequentialStepControl::saturationChange(state0.saturation(), state.saturation())
+                    : 0.0;
+                if (!solved || !step_control_.accept(change)) {
+                    if (!step_control_.stepFailed(dt, change)) {
+                        OPM_THROW(std::runtime_error, "Could not solve the substep starting at "
+                                  << unit::convert::to(current_time, unit::day) << " days.");
+                    }
+                    std::cout << "Repeating substep with a shorter time step." << std::endl;
+                    state = state0;
+                    well_state = well_state0;
+                    porevol = porevol0;
+                    continue;
+                }
+                step_control_.stepAccepted(dt, change);
             }
+            step_report->sources.insert(step_report->sources.end(),
+                                        step_sources.begin(), step_sources.end());
+            current_time = (dt < time_left) ? current_time + dt : report_end;
         }
-        transport_timer.stop();
-        double tt = transport_timer.secsSinceStart();
-        std::cout << "Transport solver took: " << tt << " seconds." << std::endl;
-        ttime += tt;
-
-        // Report volume balances.
-        Opm::computeSaturatedVol(porevol, state.saturation(), satvol);
-        polymass = Opm::computePolymerMass(porevol, state.saturation(), state.concentration(), poly_props_.deadPoreVol());
-        polymass_adsorbed = Opm::computePolymerAdsorbed(props_, poly_props_, porevol, state.maxconcentration());
-        tot_injected[0] += injected[0];
-        tot_injected[1] += injected[1];
-        tot_produced[0] += produced[0];
-        tot_produced[1] += produced[1];
-        tot_polyinj += polyinj;
-        tot_polyprod += polyprod;
-        std::cout.precision(5);
-        const int width = 18;
-        std::cout << "\nVolume and polymer mass balance: "
-            "   water(pv)           oil(pv)       polymer(kg)\n";
-        std::cout << "    Saturated volumes:     "
-                  << std::setw(width) << satvol[0]/tot_porevol_init
-                  << std::setw(width) << satvol[1]/tot_porevol_init
-                  << std::setw(width) << polymass << std::endl;
-        std::cout << "    Adsorbed volumes:      "
-                  << std::setw(width) << 0.0
-                  << std::setw(width) << 0.0
-                  << std::setw(width) << polymass_adsorbed << std::endl;
-        std::cout << "    Injected volumes:      "
-                  << std::setw(width) << injected[0]/tot_porevol_init
-                  << std::setw(width) << injected[1]/tot_porevol_init
-                  << std::setw(width) << polyinj << std::endl;
-        std::cout << "    Produced volumes:      "
-                  << std::setw(width) << produced[0]/tot_porevol_init
-                  << std::setw(width) << produced[1]/tot_porevol_init
-                  << std::setw(width) << polyprod << std::endl;
-        std::cout << "    Total inj volumes:     "
-                  << std::setw(width) << tot_injected[0]/tot_porevol_init
-                  << std::setw(width) << tot_injected[1]/tot_porevol_init
-                  << std::setw(width) << tot_polyinj << std::endl;
-        std::cout << "    Total prod volumes:    "
-                  << std::setw(width) << tot_produced[0]/tot_porevol_init
-                  << std::setw(width) << tot_produced[1]/tot_porevol_init
-                  << std::setw(width) << tot_polyprod << std::endl;
-        std::cout << "    In-place + prod - inj: "
-                  << std::setw(width) << (satvol[0] + tot_produced[0] - tot_injected[0])/tot_porevol_init
-                  << std::setw(width) << (satvol[1] + tot_produced[1] - tot_injected[1])/tot_porevol_init
-                  << std::setw(width) << (polymass + tot_polyprod - tot_polyinj + polymass_adsorbed) << std::endl;
-        std::cout << "    Init - now - pr + inj: "
-                  << std::setw(width) << (init_satvol[0] - satvol[0] - tot_produced[0] + tot_injected[0])/tot_porevol_init
-                  << std::setw(width) << (init_satvol[1] - satvol[1] - tot_produced[1] + tot_injected[1])/tot_porevol_init
-                  << std::setw(width) << (init_polymass - polymass - tot_polyprod + tot_polyinj - polymass_adsorbed)
-                  << std::endl;
-        std::cout.precision(8);
-
-        watercut.push(timer.simulationTimeElapsed() + timer.currentStepLength(),
-                      produced[0]/(produced[0] + produced[1]),
-                      tot_produced[0]/tot_porevol_init);
+
         if (wells_) {
-            wellreport.push(props_, *wells_, state.saturation(),
-                            timer.simulationTimeElapsed() + timer.currentStepLength(),
-                            well_state.bhp(), well_state.perfRates());
+            step_report->wellreport.push(props_, *wells_, state.saturation(),
+                                         timer.simulationTimeElapsed() + timer.currentStepLength(),
+                                         well_state.bhp(), well_state.perfRates());
         }
-
-        if (output_) {
-            if (output_vtk_) {
-                outputStateVtk(grid_, state, timer.currentStepNum(), output_dir_);
-            }
-            if (output_binary_) {
-                outputStateBinary(grid_, state, timer, output_dir_);
-            }
-            outputStateMatlab(grid_, state, timer.currentStepNum(), output_dir_);
-            outputWaterCut(watercut, output_dir_);
-            if (wells_) {
-                outputWellReport(wellreport, output_dir_);
-            }
+        if (need_report) {
+            step_report->porevol = porevol;
+            step_report->state = state;
+            finishStep(step_report);
+        }
+        // Output of a simulator owning its queue is complete when run()
+        // returns, and write errors surface here.
+        if (own_output_queue_) {
+            own_output_queue_->wait();
+            own_output_queue_->printMessages(std::cout);
         }
 
         total_timer.stop();
@@ -530,6 +606,61 @@ namespace Opm
 
 
 
+    void SimulatorPolymer::Impl::outputState(const SimulatorTimer& timer,
+                                             const PolymerState& state)
+    {
+        const OutputContext context = outputContext();
+        if (!output_queue_) {
+            writeState(context, timer, state, 0, 0);
+            return;
+        }
+        // Copy what the writers need, the simulation proceeds while they run.
+        // Blocks if the output thread is too far behind.
+        std::shared_ptr<SimulatorTimer> timer_copy(new SimulatorTimer(timer));
+        std::shared_ptr<PolymerState> state_copy(new PolymerState(state));
+        output_queue_->push([context, timer_copy, state_copy]() {
+                writeState(context, *timer_copy, *state_copy, 0, 0);
+            });
+    }
+
+
+
+
+    void SimulatorPolymer::Impl::finishStep(const std::shared_ptr<StepReport>& report)
+    {
+        const OutputContext context = outputContext();
+        if (!output_queue_) {
+            reportStep(context, *report, std::cout);
+            return;
+        }
+        // The output thread must not touch std::cout, which this thread
+        // keeps writing to. It formats the report and posts the text.
+        BackgroundTaskQueue* queue = output_queue_;
+        output_queue_->push([context, report, queue]() {
+                std::ostringstream os;
+                reportStep(context, *report, os);
+                queue->post(os.str());
+            });
+    }
+
+
+
+
+    OutputContext SimulatorPolymer::Impl::outputContext() const
+    {
+        OutputContext context;
+        context.grid = &grid_;
+        context.props = &props_;
+        context.poly_props = &poly_props_;
+        context.output_vtk = output_ && output_vtk_;
+        context.output_binary = output_ && output_binary_;
+        context.output_dir = output_dir_;
+        return context;
+    }
+
+
+
+
 
 
 
@@ -650,6 +781,129 @@ namespace Opm
         }
 
 
+        void writeState(const OutputContext& context,
+                        const SimulatorTimer& timer,
+                        const PolymerState& state,
+                        const Watercut* watercut,
+                        const WellReport* wellreport)
+        {
+            if (context.output_vtk) {
+                outputStateVtk(*context.grid, state, timer.currentStepNum(), context.output_dir);
+            }
+            if (context.output_binary) {
+                outputStateBinary(*context.grid, state, timer, context.output_dir);
+            }
+            outputStateMatlab(*context.grid, state, timer.currentStepNum(), context.output_dir);
+            if (watercut) {
+                outputWaterCut(*watercut, context.output_dir);
+            }
+            if (wellreport) {
+                outputWellReport(*wellreport, context.output_dir);
+            }
+        }
+
+
+        void reportStep(const OutputContext& context,
+                        const StepReport& report,
+                        std::ostream& os)
+        {
+            const IncompPropertiesInterface& props = *context.props;
+            const PolymerProperties& poly_props = *context.poly_props;
+
+            // Injected and produced volumes of the accepted substeps.
+            double injected[2] = { 0.0 };
+            double produced[2] = { 0.0 };
+            double polyinj = 0.0;
+            double polyprod = 0.0;
+            for (std::size_t i = 0; i < report.sources.size(); ++i) {
+                double substep_injected[2] = { 0.0 };
+                double substep_produced[2] = { 0.0 };
+                double substep_polyinj = 0.0;
+                double substep_polyprod = 0.0;
+                Opm::computeInjectedProduced(props, poly_props, report.sources[i],
+                                             substep_injected, substep_produced,
+                                             substep_polyinj, substep_polyprod);
+                injected[0] += substep_injected[0];
+                injected[1] += substep_injected[1];
+                produced[0] += substep_produced[0];
+                produced[1] += substep_produced[1];
+                polyinj += substep_polyinj;
+                polyprod += substep_polyprod;
+            }
+            // Totals of the simulation run, which covers this step only.
+            const double* tot_injected = injected;
+            const double* tot_produced = produced;
+            const double tot_polyinj = polyinj;
+            const double tot_polyprod = polyprod;
+            const double tot_porevol_init = report.tot_porevol_init;
+
+            // Report volume balances.
+            if (report.report_balance) {
+                PolymerBalance init_balance;
+                computePolymerBalance(props, poly_props, report.init_porevol, report.init_saturation,
+                                      report.init_concentration, report.init_maxconcentration, init_balance);
+                const double* init_satvol = init_balance.satvol;
+                const double init_polymass = init_balance.polymass + init_balance.polymass_adsorbed;
+                PolymerBalance balance;
+                computePolymerBalance(props, poly_props, report.porevol, report.state.saturation(),
+                                      report.state.concentration(), report.state.maxconcentration(), balance);
+                const double* satvol = balance.satvol;
+                const double polymass = balance.polymass;
+                const double polymass_adsorbed = balance.polymass_adsorbed;
+                os << "\nInitial saturations are    " << init_satvol[0]/tot_porevol_init
+                   << "    " << init_satvol[1]/tot_porevol_init << std::endl;
+                os.precision(5);
+                const int width = 18;
+                os << "\nVolume and polymer mass balance: "
+                    "   water(pv)           oil(pv)       polymer(kg)\n";
+                os << "    Saturated volumes:     "
+                   << std::setw(width) << satvol[0]/tot_porevol_init
+                   << std::setw(width) << satvol[1]/tot_porevol_init
+                   << std::setw(width) << polymass << std::endl;
+                os << "    Adsorbed volumes:      "
+                   << std::setw(width) << 0.0
+                   << std::setw(width) << 0.0
+                   << std::setw(width) << polymass_adsorbed << std::endl;
+                os << "    Injected volumes:      "
+                   << std::setw(width) << injected[0]/tot_porevol_init
+                   << std::setw(width) << injected[1]/tot_porevol_init
+                   << std::setw(width) << polyinj << std::endl;
+                os << "    Produced volumes:      "
+                   << std::setw(width) << produced[0]/tot_porevol_init
+                   << std::setw(width) << produced[1]/tot_porevol_init
+                   << std::setw(width) << polyprod << std::endl;
+                os << "    Total inj volumes:     "
+                   << std::setw(width) << tot_injected[0]/tot_porevol_init
+                   << std::setw(width) << tot_injected[1]/tot_porevol_init
+                   << std::setw(width) << tot_polyinj << std::endl;
+                os << "    Total prod volumes:    "
+                   << std::setw(width) << tot_produced[0]/tot_porevol_init
+                   << std::setw(width) << tot_produced[1]/tot_porevol_init
+                   << std::setw(width) << tot_polyprod << std::endl;
+                os << "    In-place + prod - inj: "
+                   << std::setw(width) << (satvol[0] + tot_produced[0] - tot_injected[0])/tot_porevol_init
+                   << std::setw(width) << (satvol[1] + tot_produced[1] - tot_injected[1])/tot_porevol_init
+                   << std::setw(width) << (polymass + tot_polyprod - tot_polyinj + polymass_adsorbed) << std::endl;
+                os << "    Init - now - pr + inj: "
+                   << std::setw(width) << (init_satvol[0] - satvol[0] - tot_produced[0] + tot_injected[0])/tot_porevol_init
+                   << std::setw(width) << (init_satvol[1] - satvol[1] - tot_produced[1] + tot_injected[1])/tot_porevol_init
+                   << std::setw(width) << (init_polymass - polymass - tot_polyprod + tot_polyinj - polymass_adsorbed)
+                   << std::endl;
+                os.precision(8);
+            }
+
+            if (report.write_output) {
+                Opm::Watercut watercut;
+                watercut.push(0.0, 0.0, 0.0);
+                watercut.push(report.timer.simulationTimeElapsed() + report.timer.currentStepLength(),
+                              produced[0]/(produced[0] + produced[1]),
+                              tot_produced[0]/tot_porevol_init);
+                writeState(context, report.timer, report.state, &watercut,
+                           report.has_wells ? &report.wellreport : 0);
+            }
+        }
+
+
         bool allNeumannBCs(const FlowBoundaryConditions* bcs)
         {
             if (bcs == NULL) {
@@ -39,6 +39,7 @@ namespace Opm
     class SimulatorTimer;
     class PolymerState;
     class WellState;
+    class BackgroundTaskQueue;
     struct SimulatorReport;
 
     /// Class collecting all necessary components for a two-phase simulation.
@@ -52,9 +53,24 @@ namespace Opm
         ///     output (true)                  write output to files?
         ///     output_dir ("output")          output directoty
         ///     output_interval (1)            output every nth step
+        ///     balance_report_interval (1)    report volume and polymer mass balance
+        ///                                    every nth step (0 = never)
+        ///     output_async (false)           write output and balance reports on a
+        ///                                    separate thread from a snapshot of the
+        ///                                    state, if no output_queue is given
+        ///     output_queue_size (2)          max pending asynchronous outputs before
+        ///                                    the simulation waits for the writer
         ///     nl_pressure_residual_tolerance (0.0) pressure solver residual tolerance (in Pascal)
         ///     nl_pressure_change_tolerance (1.0)   pressure solver change tolerance (in Pascal)
         ///     nl_pressure_maxiter (10)       max nonlinear iterations in pressure
+        ///     pressure_warm_start (true)     start pressure solves from the previous
+        ///                                    solution of the linear system
+        ///     well_control_schur (false)     re-solve pressure after well control
+        ///                                    switches through a Schur complement
+        ///                                    with respect to the well unknowns
+        ///     well_control_schur_max_wells (100) largest number of wells for which
+        ///                                    the Schur complement is used, it
+        ///                                    stores one pressure vector per well
         ///     nl_maxiter (30)                max nonlinear iterations in transport
         ///     nl_tolerance (1e-9)            transport solver absolute residual tolerance
         ///     num_transport_substeps (1)     number of transport steps per pressure step
@@ -71,6 +87,11 @@ namespace Opm
         /// \param[in] bcs              boundary conditions, treat as all noflow if null
         /// \param[in] linsolver        linear solver
         /// \param[in] gravity          if non-null, gravity vector
+        /// \param[in] output_queue     if non-null, output and balance reports are
+        ///                             written by this queue, which may outlive the
+        ///                             simulator. The caller must wait() for it.
+        ///                             If null and output_async is set, the simulator
+        ///                             owns a queue and waits for it in run().
        SimulatorPolymer(const parameter::ParameterGroup& param,
                         const UnstructuredGrid& grid,
                         const IncompPropertiesInterface& props,
@@ -81,7 +102,8 @@ namespace Opm
                         const std::vector<double>& src,
                         const FlowBoundaryConditions* bcs,
                         LinearSolverInterface& linsolver,
-                        const double* gravity);
+                        const double* gravity,
+                        BackgroundTaskQueue* output_queue = 0);
 
         /// Run the simulation.
         /// This will run succesive timesteps until timer.done() is true. It will
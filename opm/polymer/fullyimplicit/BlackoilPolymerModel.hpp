@@ -24,7 +24,9 @@
 #include <opm/autodiff/BlackoilModelBase.hpp>
 #include <opm/autodiff/BlackoilModelParameters.hpp>
 #include <opm/polymer/PolymerProperties.hpp>
+#include <opm/polymer/PolymerInflow.hpp>
 #include <opm/polymer/fullyimplicit/PolymerPropsAd.hpp>
+#include <opm/polymer/fullyimplicit/PolymerFrontChange.hpp>
 #include <opm/polymer/PolymerBlackoilState.hpp>
 #include <opm/polymer/fullyimplicit/WellStateFullyImplicitBlackoilPolymer.hpp>
 
@@ -123,6 +125,78 @@ namespace Opm {
                       WellState& well_state,
                       const bool initial_assembly);
 
+        /// Solve the Jacobian system assembled by assemble().
+        /// Unless a sequential split is set, the linear solver given
+        /// to the constructor solves the fully coupled system.
+        /// \return                          the Newton increment
+        V solveJacobianSystem() const;
+
+        /// Solve the Jacobian systems sequentially instead of fully
+        /// coupled. The pressure stage solves for pressure and the well
+        /// unknowns from the sum of the phase equations weighted by
+        /// 1/b, with saturations and concentration frozen, by the
+        /// linear solver given to the constructor. The transport stage
+        /// then solves the remaining phase equations (all except oil,
+        /// or the last phase) and the polymer equation for saturations,
+        /// rs/rv and concentration with pressure and wells frozen, by
+        /// the given transport solver, see
+        /// NewtonIterationPolymerTransport. The stages alternate the
+        /// given number of times within every Newton iteration. This is
+        /// block Gauss-Seidel on the Newton system: the equations are
+        /// not reassembled between the stages, and the transport stage
+        /// holds the phase pressures fixed rather than the total flux.
+        /// \param[in] iterations            number of pressure-transport
+        ///                                  passes, zero for fully coupled solves
+        /// \param[in] transport_linsolver   solver of the transport stage,
+        ///                                  must outlive the model
+        void setSequentialSplit(const int iterations,
+                                const NewtonIterationBlackoilInterface* transport_linsolver);
+
+        /// Converge the well equations locally in every Newton iteration.
+        /// Before the global system is assembled, the well rates and
+        /// bottom hole pressures are solved for with the reservoir state
+        /// fixed, using the water injectivity reduced by shear-thinning,
+        /// so that well control switches are settled outside the global
+        /// Newton iterations. The well unknowns remain in the global
+        /// system, where the linear solver eliminates them.
+        /// \param[in] local_well_solve      whether to solve the wells locally
+        void setLocalWellSolve(const bool local_well_solve);
+
+        /// Reuse the shear-thinning factors of the well perforations
+        /// between Newton iterations. A perforation whose water velocity
+        /// and viscosity multiplier both changed by less than the given
+        /// relative tolerance since its factor was last computed keeps
+        /// that factor; only the other perforations are solved again.
+        /// \param[in] tol                   relative tolerance, zero to solve all perforations
+        void setShearCacheTolerance(const double tol);
+
+        /// Number of perforation shear-thinning factors solved for and
+        /// reused in the current time step.
+        int shearPerforationsSolved() const { return shear_perfs_solved_; }
+        int shearPerforationsReused() const { return shear_perfs_reused_; }
+
+        /// Control the adaptive time steps by the change of saturation
+        /// and polymer concentration as well, see PolymerFrontChange.
+        /// \param[in] front_change          change targets, default none
+        void setFrontChangeTargets(const PolymerFrontChange& front_change);
+
+        /// Take the polymer injection of every time step from a schedule,
+        /// averaged over the step, instead of the concentrations in the
+        /// well state. The steps follow each other from the given start
+        /// time; a step that fails and is retried starts at the same time.
+        /// \param[in] schedule              polymer injection schedule, null for the well state
+        /// \param[in] start_time            start of the first time step
+        void setPolymerInflow(const PolymerInflowSchedule* schedule,
+                              const double start_time);
+
+        /// Relative change of the state over a time step, for the
+        /// adaptive time stepping: that of the base model, raised to
+        /// reflect the saturation and concentration change targets.
+        /// \param[in] previous              state at the start of the step
+        /// \param[in] current               state at the end of the step
+        double relativeChange(const ReservoirState& previous,
+                              const ReservoirState& current) const;
+
 
     protected:
 
@@ -140,6 +214,12 @@ namespace Opm {
         const bool has_shrate_;
         const int  poly_pos_;
         V cmax_;
+        // number of pressure-transport passes, zero when fully coupled,
+        // and the solver of the transport stage
+        int sequential_iterations_;
+        const NewtonIterationBlackoilInterface* transport_linsolver_;
+        // solve the well equations locally in every Newton iteration
+        bool local_well_solve_;
 
         // representative radius and perforation length of well perforations
         // to be used in shear-thinning computation.
@@ -150,8 +230,28 @@ namespace Opm {
 
         // shear-thinning factor for cell faces
         std::vector<double> shear_mult_faces_;
+        // water velocity and viscosity multiplier of the cell faces,
+        // kept between iterations to reuse the storage
+        std::vector<double> shear_water_vel_faces_;
+        std::vector<double> shear_visc_mult_faces_;
+        // internal face areas and porosity averages, fixed for the grid
+        V shear_face_area_;
+        V shear_face_phiavg_;
         // shear-thinning factor for well perforations
         std::vector<double> shear_mult_wells_;
+        // water velocity and viscosity multiplier of the perforations when
+        // their factors in shear_mult_wells_ were computed, the relative
+        // tolerance for reusing them, zero when off, and the counters
+        std::vector<double> shear_cache_water_vel_;
+        std::vector<double> shear_cache_visc_mult_;
+        double shear_cache_tol_;
+        int shear_perfs_solved_;
+        int shear_perfs_reused_;
+        // saturation and concentration change targets of the time steps
+        PolymerFrontChange front_change_;
+        // polymer injection schedule, if any, and the start of the next time step
+        const PolymerInflowSchedule* polymer_inflow_;
+        double inflow_time_;
 
         // Need to declare Base members we want to use here.
         using Base::grid_;
@@ -247,15 +347,42 @@ namespace Opm {
         ADB
         computeMc(const SolutionState& state) const;
 
+        /// Polymer concentration in the wellbore of every well, from the
+        /// polymer mass balance of the wellbore. The water injected at
+        /// the surface, with the concentration of the inflow schedule, is
+        /// mixed with the water entering from the reservoir through the
+        /// producing perforations, so that cross-flow and back-flow in
+        /// shut-in wells carry the reservoir polymer. The wellbore has no
+        /// storage, so the balance is solved exactly for the concentration,
+        /// which is thereby eliminated from the Newton system while its
+        /// derivatives with respect to the rates and the perforated cell
+        /// concentrations are kept.
+        /// \param[in] cq_s_water  water surface rates of the perforations, positive for injection
+        /// \param[in] mc_perf     polymer to water velocity ratio in the perforated cells
+        /// \param[in] xw          well state holding the surface concentrations
+        ADB
+        computeWellPolymerConcentration(const ADB& cq_s_water,
+                                        const ADB& mc_perf,
+                                        const WellState& xw) const;
+
         const std::vector<PhasePresence>
         phaseCondition() const {return this->phaseCondition_;}
 
+        /// Update shear_mult_wells_ from the water velocities and viscosity
+        /// multipliers of the perforations, solving only the perforations
+        /// outside the tolerance of the cached values.
+        void updateShearMultWells(const std::vector<double>& water_vel_wells,
+                                  const std::vector<double>& visc_mult_wells);
+
         /// Computing the water velocity without shear-thinning for the cell faces.
         /// The water velocity will be used for shear-thinning calculation.
         void computeWaterShearVelocityFaces(const V& transi, const std::vector<ADB>& kr,
                                             const std::vector<ADB>& phasePressure, const SolutionState& state,
                                             std::vector<double>& water_vel, std::vector<double>& visc_mult);
 
+        /// Compute the grid-static face quantities of the shear-thinning calculation.
+        void computeShearFaceGeometry();
+
         /// Computing the water velocity without shear-thinning for the well perforations based on the water flux rate.
         /// The water velocity will be used for shear-thinning calculation.
         void computeWaterShearVelocityWells(const SolutionState& state, WellState& xw, const ADB& cq_sw,
@@ -32,6 +32,7 @@
 #include <opm/autodiff/BlackoilPropsAdInterface.hpp>
 #include <opm/autodiff/GeoProps.hpp>
 #include <opm/autodiff/WellDensitySegmented.hpp>
+#include <opm/polymer/fullyimplicit/FusedAdElementwise.hpp>
 
 #include <opm/core/grid.h>
 #include <opm/core/linalg/LinearSolverInterface.hpp>
@@ -43,6 +44,10 @@
 #include <opm/core/well_controls.h>
 #include <opm/core/utility/parameters/ParameterGroup.hpp>
 
+#include <Eigen/Sparse>
+
+#include <algorithm>
+#include <array>
 #include <cassert>
 #include <cmath>
 #include <iostream>
@@ -69,6 +74,98 @@ namespace Opm {
             return pos;
         }
 
+
+
+        /// The given Jacobian blocks of the equations as one sparse
+        /// matrix, with the equations stacked and the blocks placed
+        /// side by side. Empty equations are skipped.
+        inline Eigen::SparseMatrix<double>
+        stackJacobianBlocks(const std::vector<ADB>& eqs,
+                            const std::vector<int>& blocks,
+                            const std::vector<int>& block_sizes)
+        {
+            int rows = 0;
+            for (const ADB& eq : eqs) {
+                rows += eq.size();
+            }
+            int cols = 0;
+            for (const int block : blocks) {
+                cols += block_sizes[block];
+            }
+            std::vector< Eigen::Triplet<double> > triplets;
+            int row0 = 0;
+            for (const ADB& eq : eqs) {
+                if (eq.size() == 0) {
+                    continue;
+                }
+                int col0 = 0;
+                for (const int block : blocks) {
+                    Eigen::SparseMatrix<double> jac;
+                    eq.derivative()[block].toSparse(jac);
+                    for (int k = 0; k < jac.outerSize(); ++k) {
+                        for (Eigen::SparseMatrix<double>::InnerIterator it(jac, k); it; ++it) {
+                            triplets.push_back(Eigen::Triplet<double>(row0 + it.row(), col0 + it.col(), it.value()));
+                        }
+                    }
+                    col0 += block_sizes[block];
+                }
+                row0 += eq.size();
+            }
+            Eigen::SparseMatrix<double> mat(rows, cols);
+            mat.setFromTriplets(triplets.begin(), triplets.end());
+            mat.makeCompressed();
+            return mat;
+        }
+
+
+
+        /// The values of the equations, stacked.
+        inline Eigen::VectorXd
+        stackValues(const std::vector<ADB>& eqs)
+        {
+            int rows = 0;
+            for (const ADB& eq : eqs) {
+                rows += eq.size();
+            }
+            Eigen::VectorXd val(rows);
+            int row0 = 0;
+            for (const ADB& eq : eqs) {
+                val.segment(row0, eq.size()) = eq.value().matrix();
+                row0 += eq.size();
+            }
+            return val;
+        }
+
+
+
+        /// The equations with their Jacobians restricted to the given
+        /// blocks and with values taken from rhs, stacked in the same
+        /// order. Empty equations are returned as null.
+        inline std::vector<ADB>
+        restrictToBlocks(const std::vector<ADB>& eqs,
+                         const std::vector<int>& blocks,
+                         const Eigen::VectorXd&  rhs)
+        {
+            std::vector<ADB> restricted;
+            restricted.reserve(eqs.size());
+            int row0 = 0;
+            for (const ADB& eq : eqs) {
+                if (eq.size() == 0) {
+                    restricted.push_back(ADB::null());
+                    continue;
+                }
+                std::vector<ADB::M> jacs;
+                jacs.reserve(blocks.size());
+                for (const int block : blocks) {
+                    jacs.push_back(eq.derivative()[block]);
+                }
+                V val = rhs.segment(row0, eq.size()).array();
+                restricted.push_back(ADB::function(std::move(val), std::move(jacs)));
+                row0 += eq.size();
+            }
+            return restricted;
+        }
+
     } // namespace detail
 
 
@@ -99,9 +196,17 @@ namespace Opm {
           has_plyshlog_(has_plyshlog),
           has_shrate_(has_shrate),
           poly_pos_(detail::polymerPos(fluid.phaseUsage())),
+          sequential_iterations_(0),
+          transport_linsolver_(0),
+          local_well_solve_(false),
           wells_rep_radius_(wells_rep_radius),
           wells_perf_length_(wells_perf_length),
-          wells_bore_diameter_(wells_bore_diameter)
+          wells_bore_diameter_(wells_bore_diameter),
+          shear_cache_tol_(0.0),
+          shear_perfs_solved_(0),
+          shear_perfs_reused_(0),
+          polymer_inflow_(0),
+          inflow_time_(0.0)
     {
         if (has_polymer_) {
             if (!active_[Water]) {
@@ -125,8 +230,15 @@ namespace Opm {
                 WellState& well_state)
     {
         Base::prepareStep(dt, reservoir_state, well_state);
+        if (polymer_inflow_ && wellsActive()) {
+            // Injection averaged over this time step, which may be a
+            // substep of the report step.
+            polymer_inflow_->getPerfInflowValues(inflow_time_, inflow_time_ + dt, wells(), well_state.perfPolymerInflow());
+        }
         // Initial max concentration of this time step from PolymerBlackoilState.
         cmax_ = Eigen::Map<const V>(reservoir_state.maxconcentration().data(), Opm::AutoDiffGrid::numCells(grid_));
+        shear_perfs_solved_ = 0;
+        shear_perfs_reused_ = 0;
     }
 
 
@@ -135,11 +247,16 @@ namespace Opm {
     template <class Grid>
     void
     BlackoilPolymerModel<Grid>::
-    afterStep(const double /* dt */,
+    afterStep(const double dt,
               ReservoirState& reservoir_state,
               WellState& /* well_state */)
     {
         computeCmax(reservoir_state);
+        inflow_time_ += dt;
+        if (has_plyshlog_ && shear_cache_tol_ > 0.0 && terminal_output_) {
+            std::cout << "Shear-thinning of well perforations: " << shear_perfs_solved_
+                      << " solved, " << shear_perfs_reused_ << " reused." << std::endl;
+        }
     }
 
 
@@ -240,9 +357,21 @@ namespace Opm {
             const double rho_rock = polymer_props_ad_.rockDensity();
             const V phi = Eigen::Map<const V>(&fluid_.porosity()[0], AutoDiffGrid::numCells(grid_));
             const double dead_pore_vol = polymer_props_ad_.deadPoreVol();
-            // Compute polymer accumulation term.
-            rq_[poly_pos_].accum[aix] = pv_mult * rq_[pu.phase_pos[Water]].b * sat[pu.phase_pos[Water]] * c * (1. - dead_pore_vol) 
-                                        + pv_mult * rho_rock * (1. - phi) / phi * ads;
+            // Compute polymer accumulation term,
+            //   pv_mult * b_w * s_w * c * (1 - dead_pore_vol) + pv_mult * rho_rock * (1 - phi) / phi * ads,
+            // in a single pass.
+            const V rock_factor = rho_rock * (1. - phi) / phi;
+            const std::array<const ADB*, 5> args = {{ &pv_mult, &rq_[pu.phase_pos[Water]].b, &sat[pu.phase_pos[Water]], &c, &ads }};
+            rq_[poly_pos_].accum[aix] = fusedElementwise(args, [&](const int i, const double* x, double* dfdx) {
+                    const double fluid = x[1] * x[2] * x[3] * (1. - dead_pore_vol);
+                    const double rock = rock_factor[i] * x[4];
+                    dfdx[0] = fluid + rock;
+                    dfdx[1] = x[0] * x[2] * x[3] * (1. - dead_pore_vol);
+                    dfdx[2] = x[0] * x[1] * x[3] * (1. - dead_pore_vol);
+                    dfdx[3] = x[0] * x[1] * x[2] * (1. - dead_pore_vol);
+                    dfdx[4] = x[0] * rock_factor[i];
+                    return x[0] * (fluid + rock);
+                });
         }
  
     }
@@ -256,11 +385,11 @@ namespace Opm {
     void BlackoilPolymerModel<Grid>::computeCmax(ReservoirState& state)
     {
         const int nc = AutoDiffGrid::numCells(grid_);
-        V tmp = V::Zero(nc);
+        std::vector<double>& cmax = state.maxconcentration();
+        const std::vector<double>& c = state.concentration();
         for (int i = 0; i < nc; ++i) {
-            tmp[i] = std::max(state.maxconcentration()[i], state.concentration()[i]);
+            cmax[i] = std::max(cmax[i], c[i]);
         }
-        std::copy(&tmp[0], &tmp[0] + nc, state.maxconcentration().begin());
     }
 
 
@@ -289,8 +418,8 @@ namespace Opm {
 
 
         if (has_plyshlog_) {
-            std::vector<double> water_vel;
-            std::vector<double> visc_mult;
+            std::vector<double>& water_vel = shear_water_vel_faces_;
+            std::vector<double>& visc_mult = shear_visc_mult_faces_;
 
             computeWaterShearVelocityFaces(transi, kr, state.canonical_phase_pressures, state, water_vel, visc_mult);
             if ( !polymer_props_ad_.computeShearMultLog(water_vel, visc_mult, shear_mult_faces_) ) {
@@ -333,7 +462,12 @@ namespace Opm {
 
         // Add polymer equation.
         if (has_polymer_) {
-            residual_.material_balance_eq[poly_pos_] = pvdt_ * (rq_[poly_pos_].accum[1] - rq_[poly_pos_].accum[0])
+            const V& accum0 = rq_[poly_pos_].accum[0].value();
+            const std::array<const ADB*, 1> accum1 = {{ &rq_[poly_pos_].accum[1] }};
+            residual_.material_balance_eq[poly_pos_] = fusedElementwise(accum1, [&](const int i, const double* x, double* dfdx) {
+                    dfdx[0] = pvdt_[i];
+                    return pvdt_[i] * (x[0] - accum0[i]);
+                })
                                                + ops_.div*rq_[poly_pos_].mflux;
         }
     }
@@ -353,15 +487,16 @@ namespace Opm {
         // Add well contributions to polymer mass balance equation
         if (has_polymer_) {
             const ADB mc = computeMc(state);
-            const int nc = xw.polymerInflow().size();
-            const V polyin = Eigen::Map<const V>(xw.polymerInflow().data(), nc);
+            const int nc = AutoDiffGrid::numCells(grid_);
             const int nperf = wells().well_connpos[wells().number_of_wells];
             const std::vector<int> well_cells(wells().well_cells, wells().well_cells + nperf);
-            const V poly_in_perf = subset(polyin, well_cells);
-            const V poly_mc_perf = subset(mc.value(), well_cells);
+            assert(int(xw.perfPolymerInflow().size()) == nperf);
+            const ADB poly_mc_perf = subset(mc, well_cells);
             const ADB& cq_s_water = cq_s[fluid_.phaseUsage().phase_pos[Water]];
+            // Injecting perforations carry the mixed wellbore concentration.
+            const ADB well_conc = computeWellPolymerConcentration(cq_s_water, poly_mc_perf, xw);
             Selector<double> injector_selector(cq_s_water.value());
-            const V poly_perf = injector_selector.select(poly_in_perf, poly_mc_perf);
+            const ADB poly_perf = injector_selector.select(wops_.w2p * well_conc, poly_mc_perf);
             const ADB cq_s_poly =  cq_s_water * poly_perf;
             residual_.material_balance_eq[poly_pos_] -= superset(cq_s_poly, well_cells, nc);
         }
@@ -408,6 +543,166 @@ namespace Opm {
 
 
 
+    template <class Grid>
+    void BlackoilPolymerModel<Grid>::setSequentialSplit(const int iterations,
+                                                        const NewtonIterationBlackoilInterface* transport_linsolver)
+    {
+        sequential_iterations_ = std::max(iterations, 0);
+        transport_linsolver_ = transport_linsolver;
+        if (sequential_iterations_ > 0 && !transport_linsolver_) {
+            OPM_THROW(std::logic_error, "The sequential split requires a transport linear solver.");
+        }
+    }
+
+
+
+
+
+    template <class Grid>
+    void BlackoilPolymerModel<Grid>::setLocalWellSolve(const bool local_well_solve)
+    {
+        local_well_solve_ = local_well_solve;
+    }
+
+
+
+
+
+    template <class Grid>
+    void BlackoilPolymerModel<Grid>::setShearCacheTolerance(const double tol)
+    {
+        shear_cache_tol_ = std::max(tol, 0.0);
+    }
+
+
+
+
+
+    template <class Grid>
+    void BlackoilPolymerModel<Grid>::setFrontChangeTargets(const PolymerFrontChange& front_change)
+    {
+        front_change_ = front_change;
+    }
+
+
+
+
+    template <class Grid>
+    void BlackoilPolymerModel<Grid>::setPolymerInflow(const PolymerInflowSchedule* schedule,
+                                                      const double start_time)
+    {
+        polymer_inflow_ = schedule;
+        inflow_time_ = start_time;
+    }
+
+
+
+
+
+    template <class Grid>
+    double BlackoilPolymerModel<Grid>::relativeChange(const ReservoirState& previous,
+                                                      const ReservoirState& current) const
+    {
+        return front_change_.relativeChange(Base::relativeChange(previous, current),
+                                            previous, current, polymer_props_ad_.cMax());
+    }
+
+
+
+
+
+    template <class Grid>
+    V BlackoilPolymerModel<Grid>::solveJacobianSystem() const
+    {
+        if (sequential_iterations_ == 0) {
+            return linsolver_.computeNewtonIncrement(residual_);
+        }
+
+        // Split the unknowns in the pressure stage ones (pressure and
+        // wells) and the transport stage ones (everything else).
+        const int np = fluid_.numPhases();
+        const std::vector<int>& block_sizes = residual_.material_balance_eq[0].blockPattern();
+        const int num_blocks = block_sizes.size();
+        const std::vector<int> ind = variableStateIndices();
+        std::vector<int> p_blocks = { ind[Pressure], ind[Qs], ind[Bhp] };
+        std::vector<int> t_blocks;
+        for (int block = 0; block < num_blocks; ++block) {
+            if (std::find(p_blocks.begin(), p_blocks.end(), block) == p_blocks.end()) {
+                t_blocks.push_back(block);
+            }
+        }
+
+        // Pressure equation: the phase equations weighted by 1/b.
+        // The transport equations drop one phase equation, oil if
+        // present.
+        const Opm::PhaseUsage& pu = fluid_.phaseUsage();
+        const int dropped = active_[Oil] ? pu.phase_pos[Oil] : np - 1;
+        ADB pressure_eq = residual_.material_balance_eq[0] * V(1.0 / rq_[0].b.value());
+        for (int phase = 1; phase < np; ++phase) {
+            pressure_eq += residual_.material_balance_eq[phase] * V(1.0 / rq_[phase].b.value());
+        }
+        const std::vector<ADB> p_eqs = { pressure_eq, residual_.well_flux_eq, residual_.well_eq };
+        std::vector<ADB> t_eqs;
+        for (int eq = 0; eq < int(residual_.material_balance_eq.size()); ++eq) {
+            if (eq != dropped) {
+                t_eqs.push_back(residual_.material_balance_eq[eq]);
+            }
+        }
+
+        // Coupling between the stages, moved to the right hand sides.
+        typedef Eigen::SparseMatrix<double> Mat;
+        const Mat A_pt = detail::stackJacobianBlocks(p_eqs, t_blocks, block_sizes);
+        const Mat A_tp = detail::stackJacobianBlocks(t_eqs, p_blocks, block_sizes);
+        const Eigen::VectorXd r_p = detail::stackValues(p_eqs);
+        const Eigen::VectorXd r_t = detail::stackValues(t_eqs);
+
+        // Block Gauss-Seidel passes, starting with the pressure stage.
+        // Each stage is a reduced residual for its linear solver: the
+        // pressure stage has the pressure equation and the wells and
+        // goes to the model's solver (CPR/AMG), the transport stage has
+        // no wells and goes to the transport solver (ILU(0)/BiCGStab).
+        LinearisedBlackoilResidual p_residual = residual_;
+        LinearisedBlackoilResidual t_residual = residual_;
+        t_residual.well_flux_eq = ADB::null();
+        t_residual.well_eq = ADB::null();
+        Eigen::VectorXd x_t = Eigen::VectorXd::Zero(A_pt.cols());
+        Eigen::VectorXd x_p;
+        for (int pass = 0; pass < sequential_iterations_; ++pass) {
+            const std::vector<ADB> p_stage = detail::restrictToBlocks(p_eqs, p_blocks, r_p - A_pt * x_t);
+            p_residual.material_balance_eq.assign(1, p_stage[0]);
+            p_residual.well_flux_eq = p_stage[1];
+            p_residual.well_eq = p_stage[2];
+            x_p = linsolver_.computeNewtonIncrement(p_residual).matrix();
+            t_residual.material_balance_eq = detail::restrictToBlocks(t_eqs, t_blocks, r_t - A_tp * x_p);
+            x_t = transport_linsolver_->computeNewtonIncrement(t_residual).matrix();
+        }
+        if (!x_p.allFinite() || !x_t.allFinite()) {
+            OPM_THROW(LinearSolverProblem, "Sequential split: solution of the pressure or transport system failed.");
+        }
+
+        // Scatter the stage solutions to the full increment.
+        std::vector<int> block_start(num_blocks + 1, 0);
+        for (int block = 0; block < num_blocks; ++block) {
+            block_start[block + 1] = block_start[block] + block_sizes[block];
+        }
+        V dx(block_start[num_blocks]);
+        int pos = 0;
+        for (const int block : p_blocks) {
+            dx.segment(block_start[block], block_sizes[block]) = x_p.segment(pos, block_sizes[block]).array();
+            pos += block_sizes[block];
+        }
+        pos = 0;
+        for (const int block : t_blocks) {
+            dx.segment(block_start[block], block_sizes[block]) = x_t.segment(pos, block_sizes[block]).array();
+            pos += block_sizes[block];
+        }
+        return dx;
+    }
+
+
+
+
+
     template <class Grid>
     void
     BlackoilPolymerModel<Grid>::computeMassFlux(const int               actph ,
@@ -512,7 +807,7 @@ namespace Opm {
             mob_perfcells[phase] = subset(rq_[phase].mob, well_cells);
             b_perfcells[phase] = subset(rq_[phase].b, well_cells);
         }
-        if (param_.solve_welleq_initially_ && initial_assembly) {
+        if (param_.solve_welleq_initially_ && initial_assembly && !local_well_solve_) {
             // solve the well equations as a pre-processing step
             Base::solveWellEq(mob_perfcells, b_perfcells, state, well_state);
         }
@@ -525,10 +820,7 @@ namespace Opm {
 
             const int water_pos = fluid_.phaseUsage().phase_pos[Water];
             computeWaterShearVelocityWells(state, well_state, cq_s[water_pos], water_vel_wells, visc_mult_wells);
-
-            if ( !polymer_props_ad_.computeShearMultLog(water_vel_wells, visc_mult_wells, shear_mult_wells_) ) {
-                OPM_THROW(std::runtime_error, " failed in calculating the shear factors for wells ");
-            }
+            updateShearMultWells(water_vel_wells, visc_mult_wells);
 
             // applying the shear-thinning to the water phase
             V shear_mult_wells_v = Eigen::Map<V>(shear_mult_wells_.data(), shear_mult_wells_.size());
@@ -536,6 +828,12 @@ namespace Opm {
             mob_perfcells[water_pos] = mob_perfcells[water_pos] / shear_mult_wells_adb;
         }
 
+        if (local_well_solve_) {
+            // Converge the wells with the reservoir state fixed and the
+            // shear-thinned injectivity, updating the well unknowns.
+            Base::solveWellEq(mob_perfcells, b_perfcells, state, well_state);
+        }
+
         Base::computeWellFlux(state, mob_perfcells, b_perfcells, aliveWells, cq_s);
         Base::updatePerfPhaseRatesAndPressures(cq_s, state, well_state);
         Base::addWellFluxEq(cq_s, state);
@@ -587,87 +885,162 @@ namespace Opm {
         UpwindSelector<double> upwind(grid_, ops_, dh.value());
 
         const ADB cmax = ADB::constant(cmax_, state.concentration.blockPattern());
-        const ADB mc = computeMc(state);
         ADB krw_eff = polymer_props_ad_.effectiveRelPerm(state.concentration,
                                                          cmax,
                                                          kr[canonicalPhaseIdx]);
         ADB inv_wat_eff_visc = polymer_props_ad_.effectiveInvWaterVisc(state.concentration, mu.value().data());
         rq_[ phase ].mob = tr_mult * krw_eff * inv_wat_eff_visc;
 
-        const V& polymer_conc = state.concentration.value();
-        V visc_mult_cells = polymer_props_ad_.viscMult(polymer_conc);
-        V visc_mult_faces = upwind.select(visc_mult_cells);
+        rq_[ phase ].mflux = (transi * upwind.select(b * mob)) * dh;
 
-        size_t nface = visc_mult_faces.size();
-        visc_mult.resize(nface);
-        std::copy(visc_mult_faces.data(), visc_mult_faces.data() + nface, visc_mult.begin());
+        // The face geometry and porosity do not change between iterations.
+        const int nface = ops_.internal_faces.size();
+        if (shear_face_area_.size() != nface) {
+            computeShearFaceGeometry();
+        }
 
-        rq_[ phase ].mflux = (transi * upwind.select(b * mob)) * dh;
+        // Only values are needed here, so the upwind cell of every face
+        // is picked directly, as UpwindSelector does, instead of
+        // selecting complete AutoDiffBlocks.
+        const V visc_mult_cells = polymer_props_ad_.viscMult(state.concentration.value());
+        const V& dh_val = dh.value();
+        const V& b_val = b.value();
+        const V& flux = rq_[ phase ].mflux.value();
+        const V& sw = state.saturation[fluid_.phaseUsage().phase_pos[ Water ]].value();
+        const V& krw = krw_eff.value();
+        const double shrate_const = polymer_props_ad_.shrate();
+        const double epsilon = std::numeric_limits<double>::epsilon();
+        visc_mult.resize(nface);
+        water_vel.resize(nface);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+        for (int i = 0; i < nface; ++i) {
+            const int up = (dh_val[i] >= 0.0) ? ops_.nbi(i, 0) : ops_.nbi(i, 1);
+            visc_mult[i] = visc_mult_cells[up];
+            water_vel[i] = flux[i] / (b_val[up] * shear_face_phiavg_[i] * shear_face_area_[i]);
+
+            // for SHRATE keyword treatment
+            // assuming only when upwinding water saturation is not zero
+            // there will be non-zero water velocity
+            if (has_shrate_ && std::abs(water_vel[i]) >= epsilon) {
+                const double perm = transi[i] / ops_.internal_faces[i];
+                water_vel[i] *= shrate_const * std::sqrt(shear_face_phiavg_[i] / (perm * sw[up] * krw[up]));
+            }
+        }
+    }
 
 
-        const auto& b_faces_adb = upwind.select(b);
-        std::vector<double> b_faces(b_faces_adb.value().data(), b_faces_adb.value().data() + b_faces_adb.size());
 
-        const auto& internal_faces = ops_.internal_faces;
 
-        std::vector<double> internal_face_areas;
-        internal_face_areas.resize(internal_faces.size());
 
-        for (int i = 0; i < internal_faces.size(); ++i) {
-            internal_face_areas[i] = grid_.face_areas[internal_faces[i]];
+    // Areas and average porosities of the internal faces.
+    template <class Grid>
+    void
+    BlackoilPolymerModel<Grid>::computeShearFaceGeometry()
+    {
+        const int nface = ops_.internal_faces.size();
+        shear_face_area_.resize(nface);
+        for (int i = 0; i < nface; ++i) {
+            shear_face_area_[i] = grid_.face_areas[ops_.internal_faces[i]];
         }
+        const V phi = Eigen::Map<const V>(&fluid_.porosity()[0], AutoDiffGrid::numCells(grid_));
+        shear_face_phiavg_ = (ops_.caver * phi.matrix()).array();
+    }
 
-        const ADB phi = Opm::AutoDiffBlock<double>::constant(Eigen::Map<const V>(& fluid_.porosity()[0], AutoDiffGrid::numCells(grid_), 1));
-        const ADB phiavg_adb  = ops_.caver * phi;
 
-        std::vector<double> phiavg(phiavg_adb.value().data(), phiavg_adb.value().data() + phiavg_adb.size());
 
-        water_vel.resize(nface);
-        std::copy(rq_[0].mflux.value().data(), rq_[0].mflux.value().data() + nface, water_vel.begin());
 
-        for (size_t i = 0; i < nface; ++i) {
-            water_vel[i] = water_vel[i] / (b_faces[i] * phiavg[i] * internal_face_areas[i]);
-        }
+    template <class Grid>
+    ADB
+    BlackoilPolymerModel<Grid>::computeWellPolymerConcentration(const ADB& cq_s_water,
+                                                                const ADB& mc_perf,
+                                                                const WellState& xw) const
+    {
+        const int nw = wells().number_of_wells;
+        const int nperf = wells().well_connpos[nw];
+        assert(int(xw.perfPolymerInflow().size()) == nperf);
 
-        // for SHRATE keyword treatment
-        if (has_shrate_) {
+        // Concentration injected at the surface, the same for all perforations of a well.
+        V surface_conc = V::Zero(nw);
+        for (int w = 0; w < nw; ++w) {
+            if (wells().well_connpos[w + 1] > wells().well_connpos[w]) {
+                surface_conc[w] = xw.perfPolymerInflow()[wells().well_connpos[w]];
+            }
+        }
 
-            // get the upwind water saturation
-            const Opm::PhaseUsage pu = fluid_.phaseUsage();
-            const ADB& sw = state.saturation[pu.phase_pos[ Water ]];
-            const ADB& sw_upwind_adb = upwind.select(sw);
-            std::vector<double> sw_upwind(sw_upwind_adb.value().data(), sw_upwind_adb.value().data() + sw_upwind_adb.size());
+        // Water entering the wellbore from the reservoir, at the producing perforations.
+        Selector<double> injecting_perf(cq_s_water.value());
+        const ADB perf_inflow = injecting_perf.select(ADB::constant(V::Zero(nperf)), -cq_s_water);
 
-            // get the absolute permeability for the faces
-            std::vector<double> perm;
-            perm.resize(transi.size());
+        // Water entering the wellbore from the surface: the net injection of the well.
+        const ADB net_injection = wops_.p2w * cq_s_water;
+        Selector<double> injecting_well(net_injection.value());
+        const ADB surface_inflow = injecting_well.select(net_injection, ADB::constant(V::Zero(nw)));
 
-            for (int i = 0; i < transi.size(); ++i) {
-                perm[i] = transi[i] / internal_faces[i];
-            }
+        // Mass balance: everything entering leaves through the injecting
+        // perforations (or the surface) at the wellbore concentration.
+        const ADB inflow = surface_inflow + wops_.p2w * perf_inflow;
+        const ADB mass_inflow = surface_inflow * surface_conc + wops_.p2w * (perf_inflow * mc_perf);
 
-            // get the upwind krw_eff
-            const ADB& krw_adb = upwind.select(krw_eff);
-            std::vector<double> krw_upwind(krw_adb.value().data(), krw_adb.value().data() + krw_adb.size());
+        // Wells without any inflow keep the surface concentration.
+        const V no_inflow = (inflow.value() <= 0.0).template cast<double>();
+        return mass_inflow / (inflow + no_inflow) * V(1.0 - no_inflow) + V(surface_conc * no_inflow);
+    }
 
-            const double& shrate_const = polymer_props_ad_.shrate();
 
-            const double epsilon = std::numeric_limits<double>::epsilon();
-            // std::cout << "espilon is " << epsilon << std::endl;
-            // std::cin.ignore();
 
-            for (size_t i = 0; i < water_vel.size(); ++i) {
-                // assuming only when upwinding water saturation is not zero
-                // there will be non-zero water velocity
-                if (std::abs(water_vel[i]) < epsilon) {
-                    continue;
-                }
 
-                water_vel[i] *= shrate_const * std::sqrt(phiavg[i] / (perm[i] * sw_upwind[i] * krw_upwind[i]));
+    template<class Grid>
+    void
+    BlackoilPolymerModel<Grid>::updateShearMultWells(const std::vector<double>& water_vel_wells,
+                                                     const std::vector<double>& visc_mult_wells)
+    {
+        const int nperf = water_vel_wells.size();
+        const bool use_cache = shear_cache_tol_ > 0.0
+            && int(shear_mult_wells_.size()) == nperf
+            && int(shear_cache_water_vel_.size()) == nperf;
+
+        // Perforations whose factor must be solved for.
+        std::vector<int> perfs;
+        perfs.reserve(nperf);
+        for (int i = 0; i < nperf; ++i) {
+            if (!use_cache
+                || std::abs(water_vel_wells[i] - shear_cache_water_vel_[i]) > shear_cache_tol_ * std::abs(shear_cache_water_vel_[i])
+                || std::abs(visc_mult_wells[i] - shear_cache_visc_mult_[i]) > shear_cache_tol_ * shear_cache_visc_mult_[i]) {
+                perfs.push_back(i);
+            }
+        }
+        shear_perfs_solved_ += perfs.size();
+        shear_perfs_reused_ += nperf - perfs.size();
 
+        if (int(perfs.size()) == nperf) {
+            shear_cache_water_vel_ = water_vel_wells;
+            shear_cache_visc_mult_ = visc_mult_wells;
+            if ( !polymer_props_ad_.computeShearMultLog(shear_cache_water_vel_, shear_cache_visc_mult_, shear_mult_wells_) ) {
+                OPM_THROW(std::runtime_error, " failed in calculating the shear factors for wells ");
             }
+            return;
+        }
+        if (perfs.empty()) {
+            return;
         }
 
+        std::vector<double> water_vel(perfs.size());
+        std::vector<double> visc_mult(perfs.size());
+        std::vector<double> shear_mult;
+        for (std::size_t k = 0; k < perfs.size(); ++k) {
+            water_vel[k] = water_vel_wells[perfs[k]];
+            visc_mult[k] = visc_mult_wells[perfs[k]];
+        }
+        if ( !polymer_props_ad_.computeShearMultLog(water_vel, visc_mult, shear_mult) ) {
+            OPM_THROW(std::runtime_error, " failed in calculating the shear factors for wells ");
+        }
+        for (std::size_t k = 0; k < perfs.size(); ++k) {
+            shear_mult_wells_[perfs[k]] = shear_mult[k];
+            shear_cache_water_vel_[perfs[k]] = water_vel[k];
+            shear_cache_visc_mult_[perfs[k]] = visc_mult[k];
+        }
     }
 
 
@@ -714,7 +1087,7 @@ namespace Opm {
 
         // for the injection wells
         for (size_t i = 0; i < well_cells.size(); ++i) {
-            if (xw.polymerInflow()[well_cells[i]] == 0. && selectInjectingPerforations[i] == 1) { // maybe comparison with epsilon threshold
+            if (xw.perfPolymerInflow()[i] == 0. && selectInjectingPerforations[i] == 1) { // maybe comparison with epsilon threshold
                 visc_mult_wells[i] = 1.;
             }
         }
@@ -726,7 +1099,8 @@ namespace Opm {
 
         std::vector<double> b_wells(b_perfcells.value().data(), b_perfcells.value().data() + b_perfcells.size());
 
-        for (size_t i = 0; i < water_vel_wells.size(); ++i) {
+        const int num_vel = water_vel_wells.size();
+        for (int i = 0; i < num_vel; ++i) {
             water_vel_wells[i] = b_wells[i] * water_vel_wells[i] / (phi_wells[i] * 2. * M_PI * wells_rep_radius_[i] * wells_perf_length_[i]);
             // TODO: CHECK to make sure this formulation is corectly used. Why muliplied by bW.
             // Although this formulation works perfectly with the tests compared with other formulations
@@ -735,7 +1109,7 @@ namespace Opm {
         // for SHRATE treatment
         if (has_shrate_) {
             const double& shrate_const = polymer_props_ad_.shrate();
-            for (size_t i = 0; i < water_vel_wells.size(); ++i) {
+            for (int i = 0; i < num_vel; ++i) {
                 water_vel_wells[i] = shrate_const * water_vel_wells[i] / wells_bore_diameter_[i];
             }
         }
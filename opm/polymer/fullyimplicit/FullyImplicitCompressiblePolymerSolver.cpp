@@ -33,12 +33,20 @@
 #include <opm/core/linalg/LinearSolverInterface.hpp>
 #include <opm/core/props/rock/RockCompressibility.hpp>
 #include <opm/polymer/PolymerBlackoilState.hpp>
+#include <opm/polymer/PolymerInflow.hpp>
+#include <opm/polymer/fullyimplicit/FusedAdElementwise.hpp>
+#include <opm/polymer/fullyimplicit/LocalizedNewton.hpp>
+#include <opm/polymer/fullyimplicit/NewtonIterationPolymerCPR.hpp>
 #include <opm/common/ErrorMacros.hpp>
+#include <opm/common/Exceptions.hpp>
 #include <opm/core/well_controls.h>
+#include <algorithm>
+#include <array>
 #include <cassert>
 #include <cmath>
 #include <iostream>
 #include <iomanip>
+#include <utility>
 
 // A debugging utility.
 #define DUMP(foo)                                                       \
@@ -66,6 +74,39 @@ typedef Eigen::Array<double,
 
 namespace {
 
+    // Largest difference of the values and of the Jacobian entries of
+    // two AutoDiffBlocks, each relative to the largest magnitude of
+    // the reference.
+    double
+    relativeDifference(const ADB& reference, const ADB& other)
+    {
+        const double tiny = 1e-300;
+        double diff = (reference.value() - other.value()).abs().maxCoeff()
+            / std::max(reference.value().abs().maxCoeff(), tiny);
+        const int num_blocks = reference.numBlocks();
+        for (int block = 0; block < num_blocks; ++block) {
+            Eigen::SparseMatrix<double> a;
+            Eigen::SparseMatrix<double> b;
+            reference.derivative()[block].toSparse(a);
+            other.derivative()[block].toSparse(b);
+            const Eigen::SparseMatrix<double> d = a - b;
+            double dmax = 0.0;
+            for (int k = 0; k < d.nonZeros(); ++k) {
+                dmax = std::max(dmax, std::abs(d.valuePtr()[k]));
+            }
+            double amax = 0.0;
+            for (int k = 0; k < a.nonZeros(); ++k) {
+                amax = std::max(amax, std::abs(a.valuePtr()[k]));
+            }
+            diff = std::max(diff, dmax / std::max(amax, tiny));
+        }
+        return diff;
+    }
+
+
+
+
+
     std::vector<int>
     buildAllCells(const int nc)
     {
@@ -158,6 +199,104 @@ namespace {
         return wdp;
     }
 
+
+
+
+
+    /// Value and derivatives with respect to the unknowns (p, sw, c)
+    /// of its own cell of a cell quantity.
+    struct LocalAd
+    {
+        double val;
+        double d[3];
+    };
+
+    LocalAd localFunction(const double val, const double dp, const double dsw, const double dc)
+    {
+        const LocalAd q = { val, { dp, dsw, dc } };
+        return q;
+    }
+
+    LocalAd operator+(const LocalAd& a, const LocalAd& b)
+    {
+        return localFunction(a.val + b.val, a.d[0] + b.d[0], a.d[1] + b.d[1], a.d[2] + b.d[2]);
+    }
+
+    LocalAd operator*(const double a, const LocalAd& b)
+    {
+        return localFunction(a * b.val, a * b.d[0], a * b.d[1], a * b.d[2]);
+    }
+
+    LocalAd operator*(const LocalAd& a, const LocalAd& b)
+    {
+        return localFunction(a.val * b.val,
+                             a.d[0] * b.val + a.val * b.d[0],
+                             a.d[1] * b.val + a.val * b.d[1],
+                             a.d[2] * b.val + a.val * b.d[2]);
+    }
+
+    LocalAd operator/(const LocalAd& a, const LocalAd& b)
+    {
+        const double inv = 1.0 / b.val;
+        const double q = a.val * inv;
+        return localFunction(q,
+                             (a.d[0] - q * b.d[0]) * inv,
+                             (a.d[1] - q * b.d[1]) * inv,
+                             (a.d[2] - q * b.d[2]) * inv);
+    }
+
+
+
+
+
+    /// Diagonal of the Jacobian of a quantity of a single unknown,
+    /// zero for a constant.
+    V diagonalDerivative(const ADB& q)
+    {
+        if (q.numBlocks() == 0) {
+            return V::Zero(q.size());
+        }
+        const Eigen::VectorXd ones = Eigen::VectorXd::Ones(q.size());
+        const Eigen::VectorXd diag = q.derivative()[0] * ones;
+        return diag.array();
+    }
+
+
+
+
+
+    /// Perforation values of a cell quantity, given by its values and
+    /// derivatives with respect to the cell unknowns (p, sw, c), as an
+    /// AutoDiffBlock with the block pattern bpat of the full system.
+    /// The Jacobians are copies of the perforation-to-cell pattern,
+    /// with the value of perforation j at position pos[j].
+    ADB perfQuantity(const V&                           q,
+                     const V*                           dq,
+                     const std::vector<int>&            well_cells,
+                     const std::vector<int>&            bpat,
+                     const Eigen::SparseMatrix<double>& pattern,
+                     const std::vector<int>&            pos)
+    {
+        const int nperf = well_cells.size();
+        V val(nperf);
+        for (int perf = 0; perf < nperf; ++perf) {
+            val[perf] = q[well_cells[perf]];
+        }
+        std::vector<M> jacs;
+        jacs.reserve(bpat.size());
+        for (int var = 0; var < 3; ++var) {
+            Eigen::SparseMatrix<double> jac(pattern);
+            for (int perf = 0; perf < nperf; ++perf) {
+                jac.valuePtr()[pos[perf]] = dq[var][well_cells[perf]];
+            }
+            jacs.push_back(M(jac));
+        }
+        for (std::size_t block = 3; block < bpat.size(); ++block) {
+            jacs.push_back(M(nperf, bpat[block]));
+        }
+        return ADB::function(std::move(val), std::move(jacs));
+    }
+
 } // Anonymous namespace
 
 
@@ -171,7 +310,8 @@ namespace {
                                 		   const RockCompressibility*      	rock_comp_props,
                                 		   const PolymerPropsAd&           	polymer_props_ad,
                                 		   const Wells&                    	wells,
-                                		   const NewtonIterationBlackoilInterface&    	linsolver)
+                                		   const NewtonIterationBlackoilInterface&    	linsolver,
+                                           const parameter::ParameterGroup&             param)
         : grid_  (grid)
         , fluid_ (fluid)
         , geo_   (geo)
@@ -190,7 +330,33 @@ namespace {
                         ADB::null(),
                         ADB::null(),
                         { 1.1169, 1.0031, 0.0031, 1.0 }} ) // default scaling
+        , newtonIterations_(0)
+        , linearIterations_(0)
+        , atol_(param.getDefault("newton_atol", 1.0e-12))
+        , rtol_(param.getDefault("newton_rtol", 5.0e-8))
+        , max_iter_(param.getDefault("max_iter", 15))
+        , tolerance_mb_(param.getDefault("tolerance_mb", 0.0))
+        , tolerance_cnv_(param.getDefault("tolerance_cnv", 0.0))
+        , tolerance_wells_(param.getDefault("tolerance_wells", 1.0e-3))
+        , relax_max_(param.getDefault("relax_max", 0.5))
+        , relax_increment_(param.getDefault("relax_increment", 0.1))
+        , relax_rel_tol_(param.getDefault("relax_rel_tol", 0.2))
+        , dp_max_rel_(param.getDefault("dp_max_rel", 0.8))
+        , ds_max_(param.getDefault("ds_max", 0.3))
+        , dc_max_(param.getDefault("dc_max", 0.0))
+        , active_set_tol_(param.getDefault("active_set_tol", 0.0))
+        , front_change_(param.getDefault("timestep.control.tol", 1.0e-1),
+                        param.getDefault("timestep.control.saturation_change", 0.0),
+                        param.getDefault("timestep.control.concentration_change", 0.0))
+        , polymer_inflow_(0)
+        , inflow_time_(0.0)
+        , block_assembly_(param.getDefault("block_assembly", false))
+        , block_assembly_check_(param.getDefault("block_assembly_check", 0.0))
+        , block_linsolver_(dynamic_cast<const NewtonIterationPolymerCPR*>(&linsolver))
     {
+        if (active_set_tol_ > 0.0 && !block_assembly_) {
+            OPM_THROW(std::runtime_error, "active_set_tol requires block_assembly.");
+        }
     }
 
 
@@ -203,7 +369,12 @@ namespace {
          PolymerBlackoilState& x ,
          WellStateFullyImplicitBlackoilPolymer& xw)
     {
-        const std::vector<double>& polymer_inflow = xw.polymerInflow();
+        if (polymer_inflow_) {
+            // Injection averaged over this step, which may be a substep
+            // of the report step.
+            polymer_inflow_->getPerfInflowValues(inflow_time_, inflow_time_ + dt, wells_, xw.perfPolymerInflow());
+        }
+        const std::vector<double>& polymer_inflow = xw.perfPolymerInflow();
 
         // Initial max concentration of this time step from PolymerBlackoilState.
         cmax_ = Eigen::Map<V>(&x.maxconcentration()[0], Opm::AutoDiffGrid::numCells(grid_));
@@ -211,10 +382,7 @@ namespace {
         const SolutionState state = constantState(x, xw);
         computeAccum(state, 0);
 
-        const double atol  = 1.0e-12;
-        const double rtol  = 5.0e-8;
-        const int    maxit = 15;
-        assemble(dt, x, xw, polymer_inflow);
+        assemble(dt, x, xw, polymer_inflow, std::vector<int>());
 
         const double r0  = residualNorm();
         const double r_polymer = residual_.material_balance_eq[2].value().matrix().lpNorm<Eigen::Infinity>();
@@ -223,20 +391,47 @@ namespace {
                   << std::setw(9) << it << std::setprecision(9)
                   << std::setw(18) << r0 << std::setprecision(9)
                   << std::setw(18) << r_polymer << std::endl;
-        bool resTooLarge = r0 > atol;
-        while (resTooLarge && (it < maxit)) {
-            const V dx = solveJacobianSystem();
+        std::vector< std::vector<double> > residual_history;
+        residual_history.push_back(equationNorms());
+        double omega = 1.0;
+        bool converged = isConverged(dt, r0, r0);
+        // Cells of the localised updates, empty for all cells. Only
+        // these change, so only their rows and those of their
+        // neighbours are assembled again.
+        std::vector<int> active_cells;
+        while (!converged && (it < max_iter_)) {
+            V dx = solveJacobianSystem(active_cells);
 
             // update the number of linear iterations used.
             linearIterations_ += linsolver_.iterations();
 
+            // Damp the update while the residuals oscillate or stagnate.
+            bool oscillate = false;
+            bool stagnate = false;
+            detectOscillations(residual_history, oscillate, stagnate);
+            if (oscillate || stagnate) {
+                omega = std::max(omega - relax_increment_, relax_max_);
+                std::cout << " " << (oscillate ? "Oscillating" : "Stagnating")
+                          << " behaviour detected: relaxation set to " << omega << std::endl;
+            }
+            if (omega < 1.0) {
+                dx *= omega;
+            }
+
             updateState(dx, x, xw);
-            assemble(dt, x, xw, polymer_inflow);
+            assemble(dt, x, xw, polymer_inflow, active_cells);
 
             const double r = residualNorm();
 
         	const double rr_polymer = residual_.material_balance_eq[2].value().matrix().lpNorm<Eigen::Infinity>();
-            resTooLarge = (r > atol) && (r > rtol*r0);
+            residual_history.push_back(equationNorms());
+            converged = isConverged(dt, r, r0);
+            if (active_set_tol_ > 0.0) {
+                active_cells = localizedActiveCells(cellChange(dt, dx, x), active_set_tol_, ops_);
+                if (int(active_cells.size()) == grid_.number_of_cells) {
+                    active_cells.clear();
+                }
+            }
 
             it += 1;
             newtonIterations_ += 1;
@@ -245,18 +440,29 @@ namespace {
                   << std::setw(18) << rr_polymer << std::endl;
         }
 
-        if (resTooLarge) {
-            std::cerr << "Failed to compute converged solution in " << it << " iterations. Ignoring!\n";
-            return -1;
-            // OPM_THROW(std::runtime_error, "Failed to compute converged solution in " << it << " iterations.");
+        if (!converged) {
+            // Let the caller cut the time step rather than accept the state.
+            OPM_THROW(Opm::NumericalProblem, "Failed to compute converged solution in " << it << " iterations.");
         }
 
         // Update max concentration.
         computeCmax(x);
+        inflow_time_ += dt;
 
         return it;
     }
 
+
+
+
+    void
+    FullyImplicitCompressiblePolymerSolver::setPolymerInflow(const PolymerInflowSchedule* schedule,
+                                                             const double start_time)
+    {
+        polymer_inflow_ = schedule;
+        inflow_time_ = start_time;
+    }
+
     int FullyImplicitCompressiblePolymerSolver::nonlinearIterations() const
     {
         return newtonIterations_;
@@ -326,12 +532,12 @@ namespace {
 
 
 
-    FullyImplicitCompressiblePolymerSolver::SolutionState
-    FullyImplicitCompressiblePolymerSolver::constantState(const PolymerBlackoilState& x,
-                                               			  const WellStateFullyImplicitBlackoil&     xw)
+    const std::vector<int>&
+    FullyImplicitCompressiblePolymerSolver::stateBlockPattern(const WellStateFullyImplicitBlackoil& xw)
     {
         const int nc = grid_.number_of_cells;
-        const int np = x.numPhases();
+        const int np = fluid_.numPhases();
+        const int nw = xw.bhp().size();
 
         // The block pattern assumes the following primary variables:
         //    pressure
@@ -342,50 +548,69 @@ namespace {
         // Note that oil is assumed to always be present, but is never
         // a primary variable.
         std::vector<int> bpat(np + 1, nc);
-        bpat.push_back(xw.bhp().size() * np);
-        bpat.push_back(xw.bhp().size());
+        bpat.push_back(nw * np);
+        bpat.push_back(nw);
+        if (bpat == state_bpat_) {
+            return state_bpat_;
+        }
 
-        SolutionState state(np);
+        // Jacobians of the primary variables: the identity in their own
+        // block and zero elsewhere, and -I in the saturation block for
+        // the oil saturation 1 - sw.
+        const int num_blocks = bpat.size();
+        state_jacs_.assign(num_blocks + 1, std::vector<M>());
+        for (int var = 0; var <= num_blocks; ++var) {
+            const int rows = (var < num_blocks) ? bpat[var] : nc;
+            std::vector<M>& jacs = state_jacs_[var];
+            jacs.reserve(num_blocks);
+            for (int block = 0; block < num_blocks; ++block) {
+                jacs.push_back(M(rows, bpat[block]));
+            }
+            if (var < num_blocks) {
+                jacs[var] = M::createIdentity(rows);
+            } else {
+                jacs[1] = M(V::Constant(nc, -1.0).matrix().asDiagonal());
+            }
+        }
+        state_bpat_.swap(bpat);
+        return state_bpat_;
+    }
 
-        // Pressure.
-        assert (not x.pressure().empty());
-        const V p = Eigen::Map<const V>(& x.pressure()[0], nc, 1);
-        state.pressure = ADB::constant(p, bpat);
 
-        // Temperature.
-        const V T = Eigen::Map<const V>(& x.temperature()[0], nc, 1);
-        state.temperature = ADB::constant(T);
 
-        // Saturation.
+
+
+    void
+    FullyImplicitCompressiblePolymerSolver::stateValues(const PolymerBlackoilState& x,
+                                                        const WellStateFullyImplicitBlackoil& xw,
+                                                        V& p, V& sw, V& c, V& qs, V& bhp) const
+    {
+        const int nc = grid_.number_of_cells;
+        const int np = x.numPhases();
+        const int nw = wells_.number_of_wells;
+
+        assert (not x.pressure().empty());
+        p = Eigen::Map<const V>(& x.pressure()[0], nc);
+
+        // Water saturation, every np-th entry.
         assert (not x.saturation().empty());
-        const DataBlock s = Eigen::Map<const DataBlock>(& x.saturation()[0], nc, np);
-        V so = V::Ones(nc, 1);
-        const V sw  = s.col(0);
-        so -= sw;
-        state.saturation[0] = ADB::constant(sw, bpat);
-        state.saturation[1] = ADB::constant(so, bpat);
+        sw = Eigen::Map<const V, 0, Eigen::InnerStride<> >(& x.saturation()[0], nc, Eigen::InnerStride<>(np));
+
+        assert (not x.concentration().empty());
+        c = Eigen::Map<const V>(& x.concentration()[0], nc);
 
-        // Concentration
-        assert(not x.concentration().empty());
-        const V c = Eigen::Map<const V>(&x.concentration()[0], nc);
-        state.concentration = ADB::constant(c);
-        
-        // Well rates.
-        assert (not xw.wellRates().empty());
         // Need to reshuffle well rates, from ordered by wells, then phase,
         // to ordered by phase, then wells.
-        const int nw = wells_.number_of_wells;
-        // The transpose() below switches the ordering.
-        const DataBlock wrates = Eigen::Map<const DataBlock>(& xw.wellRates()[0], nw, np).transpose();
-        const V qs = Eigen::Map<const V>(wrates.data(), nw * np);
-        state.qs = ADB::constant(qs, bpat);
+        assert (not xw.wellRates().empty());
+        qs.resize(nw * np);
+        for (int phase = 0; phase < np; ++phase) {
+            for (int w = 0; w < nw; ++w) {
+                qs[phase * nw + w] = xw.wellRates()[w * np + phase];
+            }
+        }
 
-        // Well bottom-hole pressure.
         assert (not xw.bhp().empty());
-        const V bhp = Eigen::Map<const V>(& xw.bhp()[0], xw.bhp().size());
-        state.bhp = ADB::constant(bhp, bpat);
-
-        return state;
+        bhp = Eigen::Map<const V>(& xw.bhp()[0], xw.bhp().size());
     }
 
 
@@ -393,73 +618,53 @@ namespace {
 
 
     FullyImplicitCompressiblePolymerSolver::SolutionState
-    FullyImplicitCompressiblePolymerSolver::variableState(const PolymerBlackoilState& x,
+    FullyImplicitCompressiblePolymerSolver::constantState(const PolymerBlackoilState& x,
                                                			  const WellStateFullyImplicitBlackoil&     xw)
     {
         const int nc = grid_.number_of_cells;
         const int np = x.numPhases();
+        const std::vector<int>& bpat = stateBlockPattern(xw);
 
-        std::vector<V> vars0;
-   
-        // Initial pressure.
-        assert (not x.pressure().empty());
-        const V p = Eigen::Map<const V>(& x.pressure()[0], nc, 1);
-        vars0.push_back(p);
-
-        // Initial saturation.
-        assert (not x.saturation().empty());
-        const DataBlock s = Eigen::Map<const DataBlock>(& x.saturation()[0], nc, np);
-        const V sw0 = s.col(0);
-        vars0.push_back(sw0);
-
-        // Initial concentration.
-        assert (not x.concentration().empty());
-        const V c = Eigen::Map<const V>(&x.concentration()[0], nc);
-        vars0.push_back(c);
-
-        // Initial well rates.
-        assert (not xw.wellRates().empty());
-        // Need to reshuffle well rates, from ordered by wells, then phase,
-        // to ordered by phase, then wells.
-        const int nw = wells_.number_of_wells;
-        // The transpose() below switches the ordering.
-        const DataBlock wrates = Eigen::Map<const DataBlock>(& xw.wellRates()[0], nw, np).transpose();
-        const V qs = Eigen::Map<const V>(wrates.data(), nw*np);
-        vars0.push_back(qs);
+        V p, sw, c, qs, bhp;
+        stateValues(x, xw, p, sw, c, qs, bhp);
+        V so = 1.0 - sw;
 
-        // Initial well bottom-hole pressure.
-        assert (not xw.bhp().empty());
-        const V bhp = Eigen::Map<const V>(& xw.bhp()[0], xw.bhp().size());
-        vars0.push_back(bhp);
+        SolutionState state(np);
+        state.pressure = ADB::constant(std::move(p), bpat);
+        state.temperature = ADB::constant(V(Eigen::Map<const V>(& x.temperature()[0], nc)));
+        state.saturation[0] = ADB::constant(std::move(sw), bpat);
+        state.saturation[1] = ADB::constant(std::move(so), bpat);
+        state.concentration = ADB::constant(std::move(c));
+        state.qs = ADB::constant(std::move(qs), bpat);
+        state.bhp = ADB::constant(std::move(bhp), bpat);
 
-        std::vector<ADB> vars = ADB::variables(vars0);
+        return state;
+    }
 
-        SolutionState state(np);
 
-        // Pressure.
-        int nextvar = 0;
-        state.pressure = vars[ nextvar++ ];
 
-        // Saturation.
-        const std::vector<int>& bpat = vars[0].blockPattern();
-        {
-            ADB so  = ADB::constant(V::Ones(nc, 1), bpat);
-            ADB& sw = vars[ nextvar++ ];
-            state.saturation[0] = sw;
-            so = so - sw;
-            state.saturation[1] = so;
-         }
 
-        // Concentration.
-        state.concentration = vars[nextvar++];
 
-        // Qs.
-        state.qs = vars[ nextvar++ ];
+    FullyImplicitCompressiblePolymerSolver::SolutionState
+    FullyImplicitCompressiblePolymerSolver::variableState(const PolymerBlackoilState& x,
+                                               			  const WellStateFullyImplicitBlackoil&     xw)
+    {
+        const int np = x.numPhases();
+        const int num_blocks = stateBlockPattern(xw).size();
 
-        // Bhp.
-        state.bhp = vars[ nextvar++ ];
+        // The values are copied once from the states, the Jacobians
+        // are copies of those built for the block pattern.
+        V p, sw, c, qs, bhp;
+        stateValues(x, xw, p, sw, c, qs, bhp);
+        V so = 1.0 - sw;
 
-        assert(nextvar == int(vars.size()));
+        SolutionState state(np);
+        state.pressure = ADB::function(std::move(p), std::vector<M>(state_jacs_[0]));
+        state.saturation[0] = ADB::function(std::move(sw), std::vector<M>(state_jacs_[1]));
+        state.saturation[1] = ADB::function(std::move(so), std::vector<M>(state_jacs_[num_blocks]));
+        state.concentration = ADB::function(std::move(c), std::vector<M>(state_jacs_[2]));
+        state.qs = ADB::function(std::move(qs), std::vector<M>(state_jacs_[3]));
+        state.bhp = ADB::function(std::move(bhp), std::vector<M>(state_jacs_[4]));
 
         return state;
     }
@@ -494,7 +699,19 @@ namespace {
         const V phi = Eigen::Map<const V>(&fluid_.porosity()[0], grid_.number_of_cells, 1);
 
         const double dead_pore_vol = polymer_props_ad_.deadPoreVol();
-        rq_[2].accum[aix] = pv_mult * rq_[0].b * sat[0] * c * (1. - dead_pore_vol) + pv_mult *  rho_rock * (1. - phi) / phi * ads;
+        // pv_mult * b_w * s_w * c * (1 - dead_pore_vol) + pv_mult * rho_rock * (1 - phi) / phi * ads
+        const V rock_factor = rho_rock * (1. - phi) / phi;
+        const std::array<const ADB*, 5> args = {{ &pv_mult, &rq_[0].b, &sat[0], &c, &ads }};
+        rq_[2].accum[aix] = fusedElementwise(args, [&](const int i, const double* x, double* dfdx) {
+                const double fluid = x[1] * x[2] * x[3] * (1. - dead_pore_vol);
+                const double rock = rock_factor[i] * x[4];
+                dfdx[0] = fluid + rock;
+                dfdx[1] = x[0] * x[2] * x[3] * (1. - dead_pore_vol);
+                dfdx[2] = x[0] * x[1] * x[3] * (1. - dead_pore_vol);
+                dfdx[3] = x[0] * x[1] * x[2] * (1. - dead_pore_vol);
+                dfdx[4] = x[0] * rock_factor[i];
+                return x[0] * (fluid + rock);
+            });
     }
 	
 
@@ -523,7 +740,31 @@ namespace {
     assemble(const double             dt,
              const PolymerBlackoilState& x,
              const WellStateFullyImplicitBlackoil& xw,
-             const std::vector<double>& polymer_inflow)
+             const std::vector<double>& polymer_inflow,
+             const std::vector<int>& changed_cells)
+    {
+        if (!block_assembly_) {
+            assembleOperators(dt, x, xw, polymer_inflow);
+        } else if (block_assembly_check_ > 0.0) {
+            assembleOperators(dt, x, xw, polymer_inflow);
+            const LinearisedBlackoilResidual reference = residual_;
+            assembleBlocks(dt, x, xw, polymer_inflow, changed_cells);
+            checkBlockAssembly(reference);
+        } else {
+            assembleBlocks(dt, x, xw, polymer_inflow, changed_cells);
+        }
+    }
+
+
+
+
+
+    void
+    FullyImplicitCompressiblePolymerSolver::
+    assembleOperators(const double             dt,
+                      const PolymerBlackoilState& x,
+                      const WellStateFullyImplicitBlackoil& xw,
+                      const std::vector<double>& polymer_inflow)
     {
         // Create the primary variables.
         //
@@ -551,7 +792,12 @@ namespace {
                                     + ops_.div*rq_[0].mflux;
         residual_.material_balance_eq[1] = pvdt*(rq_[1].accum[1] - rq_[1].accum[0])
                                     + ops_.div*rq_[1].mflux;
-        residual_.material_balance_eq[2] = pvdt*(rq_[2].accum[1] - rq_[2].accum[0]) //+ cell / dt * (rq_[2].ads[1] - rq_[2].ads[0])
+        const V& accum0 = rq_[2].accum[0].value();
+        const std::array<const ADB*, 1> accum1 = {{ &rq_[2].accum[1] }};
+        residual_.material_balance_eq[2] = fusedElementwise(accum1, [&](const int i, const double* x, double* dfdx) {
+                dfdx[0] = pvdt[i];
+                return pvdt[i] * (x[0] - accum0[i]);
+            }) //+ cell / dt * (rq_[2].ads[1] - rq_[2].ads[0])
                                     + ops_.div*rq_[2].mflux;
 
         // -------- Extra (optional) sg or rs equation, and rs contributions to the mass balance equations --------
@@ -562,7 +808,36 @@ namespace {
         // -------- Well equation, and well contributions to the mass balance equations --------
 
         // Contribution to mass balance will have to wait.
+        const int np = wells_.number_of_phases;
+        const int nw = wells_.number_of_wells;
+        const int nperf = wells_.well_connpos[nw];
+        const std::vector<int> well_cells(wells_.well_cells, wells_.well_cells + nperf);
+
+        std::vector<ADB> perf_b(np, ADB::null());
+        std::vector<ADB> perf_mob(np, ADB::null());
+        std::vector<V> perf_rho(np);
+        for (int phase = 0; phase < np; ++phase) {
+            perf_b[phase] = subset(rq_[phase].b, well_cells);
+            perf_mob[phase] = subset(rq_[phase].mob, well_cells);
+            perf_rho[phase] = fluid_.surfaceDensity(phase, well_cells) * perf_b[phase].value();
+        }
+        const V perf_mc = subset(mc, well_cells).value();
+        assembleWellEq(state, perf_b, perf_mob, perf_mc, perf_rho, polymer_inflow);
+    }
+
+
 
+
+
+    void
+    FullyImplicitCompressiblePolymerSolver::
+    assembleWellEq(const SolutionState&        state,
+                   const std::vector<ADB>&     perf_b,
+                   const std::vector<ADB>&     perf_mob,
+                   const V&                    perf_mc,
+                   const std::vector<V>&       perf_rho,
+                   const std::vector<double>&  polymer_inflow)
+    {
         const int nc = grid_.number_of_cells;
         const int np = wells_.number_of_phases;
         const int nw = wells_.number_of_wells;
@@ -590,24 +865,15 @@ namespace {
                 assert(g[dd] == 0.0);
             }
         }
-        ADB cell_rho_total = ADB::constant(V::Zero(nc), state.pressure.blockPattern());
-		std::vector<ADB> press = computePressures(state);
-        const ADB& temp = state.temperature;
-        const std::vector<PhasePresence> cond = phaseCondition();
-        for (int phase = 0; phase < 2; ++phase) {
-            const ADB cell_rho = fluidDensity(phase, press[phase], temp, cond, cells_);
-            cell_rho_total += state.saturation[phase] * cell_rho;
-        }
-        ADB inj_rho_total = ADB::constant(V::Zero(nperf), state.pressure.blockPattern());
-        assert(np == wells_.number_of_phases);
+        // Only the values of the densities enter the well equations.
+        V rho_perf_cell = V::Zero(nperf);
+        V rho_perf_well = V::Zero(nperf);
         const DataBlock compi = Eigen::Map<const DataBlock>(wells_.comp_frac, nw, np);
         for (int phase = 0; phase < 2; ++phase) {
-            const ADB cell_rho = fluidDensity(phase, press[phase], temp, cond, cells_);
             const V fraction = compi.col(phase);
-            inj_rho_total += (wops_.w2p * fraction.matrix()).array() * subset(cell_rho, well_cells);
+            rho_perf_cell += subset(state.saturation[phase].value(), well_cells) * perf_rho[phase];
+            rho_perf_well += (wops_.w2p * fraction.matrix()).array() * perf_rho[phase];
         }
-        const V rho_perf_cell = subset(cell_rho_total, well_cells).value();
-        const V rho_perf_well = inj_rho_total.value();
         V prodperfs = V::Constant(nperf, -1.0);
         for (int w = 0; w < nw; ++w) {
             if (wells_.type[w] == PRODUCER) {
@@ -624,36 +890,32 @@ namespace {
         // DUMP(nkgradp_well);
         const Selector<double> cell_to_well_selector(nkgradp_well.value());
         ADB well_rates_all = ADB::constant(V::Zero(nw*np), state.bhp.blockPattern());
-        ADB perf_total_mob = subset(rq_[0].mob, well_cells) + subset(rq_[1].mob, well_cells);
+        ADB perf_total_mob = perf_mob[0] + perf_mob[1];
         std::vector<ADB> well_contribs(np, ADB::null());
         std::vector<ADB> well_perf_rates(np, ADB::null());
         for (int phase = 0; phase < np; ++phase) {
-            const ADB& cell_b = rq_[phase].b;
-            const ADB perf_b = subset(cell_b, well_cells);
-            const ADB& cell_mob = rq_[phase].mob;
             const V well_fraction = compi.col(phase);
             // Using total mobilities for all phases for injection.
             const ADB perf_mob_injector = (wops_.w2p * well_fraction.matrix()).array() * perf_total_mob;
-            const ADB perf_mob = producer.select(subset(cell_mob, well_cells),
-                                                 perf_mob_injector);
-            const ADB perf_flux = perf_mob * (nkgradp_well); // No gravity term for perforations.
-            well_perf_rates[phase] = (perf_flux * perf_b);
+            const ADB perf_phase_mob = producer.select(perf_mob[phase],
+                                                       perf_mob_injector);
+            const ADB perf_flux = perf_phase_mob * (nkgradp_well); // No gravity term for perforations.
+            well_perf_rates[phase] = (perf_flux * perf_b[phase]);
             const ADB well_rates = wops_.p2w * well_perf_rates[phase];
             well_rates_all += superset(well_rates, Span(nw, 1, phase*nw), nw*np);
 
             // const ADB well_contrib = superset(perf_flux*perf_b, well_cells, nc);
-            well_contribs[phase] = superset(perf_flux*perf_b, well_cells, nc);
+            well_contribs[phase] = superset(well_perf_rates[phase], well_cells, nc);
             // DUMP(well_contribs[phase]);
             residual_.material_balance_eq[phase] += well_contribs[phase];
         }
 
         // well rates contribs to polymer mass balance eqn.
         // for injection wells.
-        const V polyin = Eigen::Map<const V>(& polymer_inflow[0], nc);
-        const V poly_in_perf = subset(polyin, well_cells);
-		const V poly_mc_cell = subset(mc, well_cells).value();
-		const V poly_in_c = poly_in_perf;// * poly_mc_cell;
-        const V poly_mc = producer.select(poly_mc_cell, poly_in_c);
+        assert(int(polymer_inflow.size()) == nperf);
+        const V poly_in_perf = Eigen::Map<const V>(polymer_inflow.data(), nperf);
+		const V poly_in_c = poly_in_perf;// * perf_mc;
+        const V poly_mc = producer.select(perf_mc, poly_in_c);
         
 		residual_.material_balance_eq[2] += superset(well_perf_rates[0] * poly_mc, well_cells, nc);
         // Set the well flux equation
@@ -694,9 +956,543 @@ namespace {
 
 
 
+    void
+    FullyImplicitCompressiblePolymerSolver::buildBlockPattern()
+    {
+        const int nc = grid_.number_of_cells;
+        const int ni = ops_.internal_faces.size();
+
+        // Every cell couples to itself and its face neighbours.
+        std::vector< std::vector<int> > nbrs(nc);
+        for (int c = 0; c < nc; ++c) {
+            nbrs[c].push_back(c);
+        }
+        for (int i = 0; i < ni; ++i) {
+            const int c1 = ops_.nbi(i, 0);
+            const int c2 = ops_.nbi(i, 1);
+            nbrs[c1].push_back(c2);
+            nbrs[c2].push_back(c1);
+        }
+        block_rowptr_.assign(nc + 1, 0);
+        block_cols_.clear();
+        for (int c = 0; c < nc; ++c) {
+            std::sort(nbrs[c].begin(), nbrs[c].end());
+            nbrs[c].erase(std::unique(nbrs[c].begin(), nbrs[c].end()), nbrs[c].end());
+            block_cols_.insert(block_cols_.end(), nbrs[c].begin(), nbrs[c].end());
+            block_rowptr_[c + 1] = block_cols_.size();
+        }
+
+        const auto position = [this](const int row, const int col) {
+            const auto begin = block_cols_.begin() + block_rowptr_[row];
+            const auto end = block_cols_.begin() + block_rowptr_[row + 1];
+            return int(std::lower_bound(begin, end, col) - block_cols_.begin());
+        };
+        block_diag_.resize(nc);
+        for (int c = 0; c < nc; ++c) {
+            block_diag_[c] = position(c, c);
+        }
+        block_face_.resize(2*ni);
+        for (int i = 0; i < ni; ++i) {
+            const int c1 = ops_.nbi(i, 0);
+            const int c2 = ops_.nbi(i, 1);
+            block_face_[2*i + 0] = position(c1, c2);
+            block_face_[2*i + 1] = position(c2, c1);
+        }
+        block_transpose_.resize(block_cols_.size());
+        for (int row = 0; row < nc; ++row) {
+            for (int k = block_rowptr_[row]; k < block_rowptr_[row + 1]; ++k) {
+                block_transpose_[k] = position(block_cols_[k], row);
+            }
+        }
+        block_jac_.assign(9*block_cols_.size(), 0.0);
+
+        // One matrix per equation and unknown. The block pattern is
+        // structurally symmetric, so the column major matrices take the
+        // row pointers of the blocks, and only values change later on.
+        const int nnz = block_cols_.size();
+        block_eq_jac_.assign(9, Eigen::SparseMatrix<double>(nc, nc));
+        for (Eigen::SparseMatrix<double>& jac : block_eq_jac_) {
+            jac.resizeNonZeros(nnz);
+            std::copy(block_rowptr_.begin(), block_rowptr_.end(), jac.outerIndexPtr());
+            std::copy(block_cols_.begin(), block_cols_.end(), jac.innerIndexPtr());
+            std::fill(jac.valuePtr(), jac.valuePtr() + nnz, 0.0);
+        }
+    }
+
+
+
+
+
+    void
+    FullyImplicitCompressiblePolymerSolver::buildPerfPattern(const std::vector<int>& well_cells)
+    {
+        const int nc = grid_.number_of_cells;
+        const int nperf = well_cells.size();
+        typedef Eigen::Triplet<double> Tri;
+        std::vector<Tri> entries;
+        entries.reserve(nperf);
+        for (int perf = 0; perf < nperf; ++perf) {
+            entries.push_back(Tri(perf, well_cells[perf], 0.0));
+        }
+        perf_pattern_ = Eigen::SparseMatrix<double>(nperf, nc);
+        perf_pattern_.setFromTriplets(entries.begin(), entries.end());
+        perf_pos_.resize(nperf);
+        for (int cell = 0; cell < nc; ++cell) {
+            for (int k = perf_pattern_.outerIndexPtr()[cell]; k < perf_pattern_.outerIndexPtr()[cell + 1]; ++k) {
+                perf_pos_[perf_pattern_.innerIndexPtr()[k]] = k;
+            }
+        }
+        perf_cells_ = well_cells;
+    }
+
+
+
+
+
+    // Assemble the same equations as assemble(), but without operator
+    // matrices for the reservoir part. Cell quantities are evaluated
+    // cell by cell with fixed-size derivatives with respect to the
+    // unknowns of their own cell, the fluxes are formed face by face and
+    // their derivatives added directly to the 3x3 blocks of the two
+    // cells involved. The well equations are still assembled with
+    // AutoDiffBlock operators.
+    //
+    // If only the unknowns of changed_cells have changed since the last
+    // assembly of this time step, only the quantities of these cells
+    // are evaluated, and only the rows of these cells and their face
+    // neighbours are assembled. The other rows depend on unchanged
+    // quantities only and are kept, so the residual stays exact in
+    // every cell. An empty changed_cells means all cells.
+    void
+    FullyImplicitCompressiblePolymerSolver::
+    assembleBlocks(const double                dt,
+                   const PolymerBlackoilState& x,
+                   const WellStateFullyImplicitBlackoil& xw,
+                   const std::vector<double>& polymer_inflow,
+                   const std::vector<int>&     changed_cells)
+    {
+        const int nc = grid_.number_of_cells;
+        const int ni = ops_.internal_faces.size();
+        if (int(block_diag_.size()) != nc) {
+            buildBlockPattern();
+        }
+        BlockCellState& q = block_cells_;
+        // The water mobility of every cell uses the water viscosity of
+        // cell 0, as in computeMobility(), so a change of cell 0 changes
+        // all cells.
+        const bool fresh = int(q.mc.size()) != nc;
+        const bool all_cells = fresh || changed_cells.empty()
+            || std::find(changed_cells.begin(), changed_cells.end(), 0) != changed_cells.end();
+        if (fresh) {
+            const int ncd[] = { 3, 3, 2, 2, 2, 2 };
+            std::vector<CellDerivatives>* qd[] = { &q.acc, &q.bmob, &q.press, &q.rho, &q.b, &q.mob };
+            for (int k = 0; k < 6; ++k) {
+                qd[k]->resize(ncd[k]);
+                for (CellDerivatives& cd : *qd[k]) {
+                    cd.resize(nc);
+                }
+            }
+            q.mc = V::Zero(nc);
+            q.res.assign(3, V::Zero(nc));
+        }
+        const std::vector<int>& cells = all_cells ? cells_ : changed_cells;
+        const int n = cells.size();
+
+        const SolutionState state = variableState(x, xw);
+        const V pvdt = geo_.poreVolume() / dt;
+        const V& p = state.pressure.value();
+        const V& sw = state.saturation[0].value();
+        const V& conc = state.concentration.value();
+
+        // The fluid interface only takes AutoDiffBlocks: the saturation
+        // functions are evaluated with sw, the PVT functions with the
+        // phase pressure as the single unknown, giving diagonal
+        // Jacobians. The phase pressures are those of computePressures().
+        // Entry k of these arrays belongs to cell cells[k].
+        const std::vector<int> one_block(1, n);
+        const ADB sw_var = ADB::variable(0, subset(sw, cells), one_block);
+        const ADB so_var = ADB::constant(V::Ones(n), one_block) - sw_var;
+        const ADB sg = ADB::constant(V::Zero(n), one_block);
+        const std::vector<ADB> kr = fluid_.relperm(sw_var, so_var, sg, cells);
+        const std::vector<ADB> pc = fluid_.capPress(sw_var, so_var, sg, cells);
+        const V dkrw = diagonalDerivative(kr[Water]);
+        const V dkro = diagonalDerivative(kr[Oil]);
+        const V pc_o = pc[Oil].value();
+        const V dpc_o = diagonalDerivative(pc[Oil]);
+        const V p_cells = subset(p, cells);
+        const V phase_press[2] = { p_cells - (pc[Water].value() - pc_o), p_cells + pc_o };
+        const V dphase_press_dsw[2] = { dpc_o - diagonalDerivative(pc[Water]), dpc_o };
+        const ADB temp = ADB::constant(subset(state.temperature.value(), cells));
+        std::vector<PhasePresence> cond(n);
+        for (int k = 0; k < n; ++k) {
+            cond[k] = phaseCondition_[cells[k]];
+        }
+        V b[2], db[2], mu[2], dmu[2];
+        for (int phase = 0; phase < 2; ++phase) {
+            const ADB pp = ADB::variable(0, phase_press[phase], one_block);
+            const ADB bq = fluidReciprocFVF(phase, pp, temp, cond, cells);
+            const ADB muq = fluidViscosity(phase, pp, temp, cond, cells);
+            b[phase] = bq.value();
+            db[phase] = diagonalDerivative(bq);
+            mu[phase] = muq.value();
+            dmu[phase] = diagonalDerivative(muq);
+        }
+        if (all_cells) {
+            q.mu_w0 = mu[Water][0];
+        }
+
+        // Everything else cell by cell, with the derivatives with
+        // respect to the unknowns of the cell, following computeAccum()
+        // and computeMobility().
+        const PolymerProperties& polymer_props = polymer_props_ad_.polymerProperties();
+        const bool rock_comp = rock_comp_props_ && rock_comp_props_->isActive();
+        const V phi = Eigen::Map<const V>(&fluid_.porosity()[0], nc, 1);
+        const V rock_factor = polymer_props_ad_.rockDensity() * (1. - phi) / phi;
+        const double fluid_factor = 1. - polymer_props_ad_.deadPoreVol();
+        const V rhos[2] = { fluid_.surfaceDensity(Water, cells), fluid_.surfaceDensity(Oil, cells) };
+        const double* mu_w = &q.mu_w0;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+        for (int k = 0; k < n; ++k) {
+            const int c = cells[k];
+            LocalAd pv_mult = localFunction(1.0, 0.0, 0.0, 0.0);
+            LocalAd tr_mult = localFunction(1.0, 0.0, 0.0, 0.0);
+            if (rock_comp) {
+                pv_mult = localFunction(rock_comp_props_->poroMult(p[c]),
+                                        rock_comp_props_->poroMultDeriv(p[c]), 0.0, 0.0);
+                tr_mult = localFunction(rock_comp_props_->transMult(p[c]),
+                                        rock_comp_props_->transMultDeriv(p[c]), 0.0, 0.0);
+            }
+            const LocalAd s_w = localFunction(sw[c], 0.0, 1.0, 0.0);
+            const LocalAd s_o = localFunction(1.0 - sw[c], 0.0, -1.0, 0.0);
+            const LocalAd cc = localFunction(conc[c], 0.0, 0.0, 1.0);
+            LocalAd bp[2];
+            for (int phase = 0; phase < 2; ++phase) {
+                const double dpp_dsw = dphase_press_dsw[phase][k];
+                bp[phase] = localFunction(b[phase][k], db[phase][k], db[phase][k] * dpp_dsw, 0.0);
+                const LocalAd pr = localFunction(phase_press[phase][k], 1.0, dpp_dsw, 0.0);
+                const LocalAd rho = rhos[phase][k] * bp[phase];
+                q.press[phase].set(c, pr.val, pr.d);
+                q.rho[phase].set(c, rho.val, rho.d);
+                q.b[phase].set(c, bp[phase].val, bp[phase].d);
+            }
+            const LocalAd mu_o = localFunction(mu[Oil][k], dmu[Oil][k],
+                                               dmu[Oil][k] * dphase_press_dsw[Oil][k], 0.0);
+
+            double ads = 0.0, dads = 0.0;
+            polymer_props.adsorptionWithDer(conc[c], cmax_[c], ads, dads);
+            const LocalAd acc[3] = {
+                pv_mult * bp[Water] * s_w,
+                pv_mult * bp[Oil] * s_o,
+                pv_mult * (fluid_factor * (bp[Water] * s_w * cc)
+                           + rock_factor[c] * localFunction(ads, 0.0, 0.0, dads))
+            };
+
+            // The relative permeabilities are functions of sw alone.
+            const double relperm[2] = { kr[Water].value()[k], kr[Oil].value()[k] };
+            const double drelperm_ds[4] = { dkrw[k], 0.0, 0.0, 0.0 };
+            double krw_eff = 0.0, dkrw_eff_ds = 0.0, dkrw_eff_dc = 0.0;
+            polymer_props.effectiveRelpermWithDer(conc[c], cmax_[c], relperm, drelperm_ds,
+                                                  krw_eff, dkrw_eff_ds, dkrw_eff_dc);
+            double inv_mu_w_eff = 0.0, dinv_mu_w_eff = 0.0;
+            polymer_props.effectiveInvViscWithDer(conc[c], mu_w, inv_mu_w_eff, dinv_mu_w_eff);
+            double m = 0.0, dm = 0.0;
+            polymer_props.computeMcWithDer(conc[c], m, dm);
+            const LocalAd mob_w = tr_mult * localFunction(krw_eff, 0.0, dkrw_eff_ds, dkrw_eff_dc)
+                * localFunction(inv_mu_w_eff, 0.0, 0.0, dinv_mu_w_eff);
+            const LocalAd mob_o = tr_mult * localFunction(relperm[1], 0.0, dkro[k], 0.0) / mu_o;
+            const LocalAd mob_p = localFunction(m, 0.0, 0.0, dm) * mob_w;
+            const LocalAd bmob[3] = { bp[Water] * mob_w, bp[Oil] * mob_o, bp[Water] * mob_p };
+            for (int eq = 0; eq < 3; ++eq) {
+                q.acc[eq].set(c, acc[eq].val, acc[eq].d);
+                q.bmob[eq].set(c, bmob[eq].val, bmob[eq].d);
+            }
+            q.mob[Water].set(c, mob_w.val, mob_w.d);
+            q.mob[Oil].set(c, mob_o.val, mob_o.d);
+            q.mc[c] = m;
+        }
+        // The convergence measures use the formation volume factors.
+        for (int phase = 0; phase < 2; ++phase) {
+            rq_[phase].b = ADB::constant(q.b[phase].val);
+        }
+
+        // Rows to assemble: the changed cells and their face neighbours.
+        std::vector<char> row(nc, all_cells);
+        if (!all_cells) {
+            std::vector<char> changed(nc, 0);
+            for (const int c : cells) {
+                changed[c] = 1;
+            }
+            for (int i = 0; i < ni; ++i) {
+                const int c1 = ops_.nbi(i, 0);
+                const int c2 = ops_.nbi(i, 1);
+                if (changed[c1] || changed[c2]) {
+                    row[c1] = row[c2] = 1;
+                }
+            }
+        }
+
+        // Accumulation terms.
+        for (int c = 0; c < nc; ++c) {
+            if (!row[c]) {
+                continue;
+            }
+            std::fill(block_jac_.begin() + 9*block_rowptr_[c], block_jac_.begin() + 9*block_rowptr_[c + 1], 0.0);
+            double* blk = &block_jac_[9*block_diag_[c]];
+            for (int eq = 0; eq < 3; ++eq) {
+                q.res[eq][c] = pvdt[c] * (q.acc[eq].val[c] - rq_[eq].accum[0].value()[c]);
+                for (int var = 0; var < 3; ++var) {
+                    blk[3*eq + var] = pvdt[c] * q.acc[eq].d[var][c];
+                }
+            }
+        }
+
+        // Upwinded fluxes, b*mob*head, across each internal face. The
+        // polymer is transported with the water head.
+        const V& trans_all = geo_.transmissibility();
+        const V& z = geo_.z();
+        const double grav = geo_.gravity()[2];
+        for (int i = 0; i < ni; ++i) {
+            const int c1 = ops_.nbi(i, 0);
+            const int c2 = ops_.nbi(i, 1);
+            if (!row[c1] && !row[c2]) {
+                continue;
+            }
+            const double t = trans_all[ops_.internal_faces[i]];
+            const double dz = z[c1] - z[c2];
+            double* b11 = &block_jac_[9*block_diag_[c1]];
+            double* b12 = &block_jac_[9*block_face_[2*i + 0]];
+            double* b21 = &block_jac_[9*block_face_[2*i + 1]];
+            double* b22 = &block_jac_[9*block_diag_[c2]];
+            for (int phase = 0; phase < 2; ++phase) {
+                const CellDerivatives& pr = q.press[phase];
+                const CellDerivatives& rho = q.rho[phase];
+                const double gz = 0.5 * grav * dz;
+                const double head = t * (pr.val[c1] - pr.val[c2] - gz * (rho.val[c1] + rho.val[c2]));
+                double dhead1[3];
+                double dhead2[3];
+                for (int var = 0; var < 3; ++var) {
+                    dhead1[var] = t * (pr.d[var][c1] - gz * rho.d[var][c1]);
+                    dhead2[var] = t * (-pr.d[var][c2] - gz * rho.d[var][c2]);
+                }
+                const bool from_c1 = head >= 0.0;
+                const int up = from_c1 ? c1 : c2;
+                for (int eq = phase; eq < 3; eq += 2) {
+                    const CellDerivatives& bm = q.bmob[eq];
+                    const double flux = bm.val[up] * head;
+                    for (int var = 0; var < 3; ++var) {
+                        double dflux1 = bm.val[up] * dhead1[var];
+                        double dflux2 = bm.val[up] * dhead2[var];
+                        if (from_c1) {
+                            dflux1 += bm.d[var][c1] * head;
+                        } else {
+                            dflux2 += bm.d[var][c2] * head;
+                        }
+                        if (row[c1]) {
+                            b11[3*eq + var] += dflux1;
+                            b12[3*eq + var] += dflux2;
+                        }
+                        if (row[c2]) {
+                            b21[3*eq + var] -= dflux1;
+                            b22[3*eq + var] -= dflux2;
+                        }
+                    }
+                    if (row[c1]) {
+                        q.res[eq][c1] += flux;
+                    }
+                    if (row[c2]) {
+                        q.res[eq][c2] -= flux;
+                    }
+                }
+            }
+        }
+
+        // The blocks stay in block_jac_, the residual gets the values
+        // and empty Jacobians for the well terms to be added to.
+        const std::vector<int>& bpat = state.pressure.blockPattern();
+        for (int eq = 0; eq < 3; ++eq) {
+            std::vector<M> jacs;
+            jacs.reserve(bpat.size());
+            for (std::size_t block = 0; block < bpat.size(); ++block) {
+                jacs.push_back(M(nc, bpat[block]));
+            }
+            residual_.material_balance_eq[eq] = ADB::function(V(q.res[eq]), std::move(jacs));
+        }
+
+        // Well equations.
+        const int np = wells_.number_of_phases;
+        const int nw = wells_.number_of_wells;
+        const int nperf = wells_.well_connpos[nw];
+        const std::vector<int> well_cells(wells_.well_cells, wells_.well_cells + nperf);
+        if (well_cells != perf_cells_ || perf_pattern_.cols() != nc) {
+            buildPerfPattern(well_cells);
+        }
+        std::vector<ADB> perf_b(np, ADB::null());
+        std::vector<ADB> perf_mob(np, ADB::null());
+        std::vector<V> perf_rho(np);
+        for (int phase = 0; phase < np; ++phase) {
+            perf_b[phase] = perfQuantity(q.b[phase].val, q.b[phase].d, well_cells, bpat, perf_pattern_, perf_pos_);
+            perf_mob[phase] = perfQuantity(q.mob[phase].val, q.mob[phase].d, well_cells, bpat, perf_pattern_, perf_pos_);
+            perf_rho[phase] = subset(q.rho[phase].val, well_cells);
+        }
+        const V perf_mc = subset(q.mc, well_cells);
+        assembleWellEq(state, perf_b, perf_mob, perf_mc, perf_rho, polymer_inflow);
+    }
+
+
+
+
+
+    // Compare the residual and Jacobian of the block assembly with
+    // those of the operator assembly, which is the reference.
+    void
+    FullyImplicitCompressiblePolymerSolver::
+    checkBlockAssembly(const LinearisedBlackoilResidual& reference) const
+    {
+        const LinearisedBlackoilResidual full = fullResidual();
+        const char* names[] = { "water", "oil", "polymer" };
+        double max_diff = 0.0;
+        for (int eq = 0; eq < 3; ++eq) {
+            const double diff = relativeDifference(reference.material_balance_eq[eq],
+                                                   full.material_balance_eq[eq]);
+            std::cout << "Block assembly, " << names[eq] << " equation, relative difference: "
+                      << diff << std::endl;
+            max_diff = std::max(max_diff, diff);
+        }
+        if (wells_.number_of_wells > 0) {
+            max_diff = std::max(max_diff, relativeDifference(reference.well_flux_eq, residual_.well_flux_eq));
+            max_diff = std::max(max_diff, relativeDifference(reference.well_eq, residual_.well_eq));
+        }
+        if (!(max_diff <= block_assembly_check_)) {
+            OPM_THROW(std::runtime_error, "Block assembly differs from the operator assembly by "
+                      << max_diff << ", more than block_assembly_check = " << block_assembly_check_);
+        }
+    }
+
+
+
+
+
+    // The residual of the block assembly with the blocks added to the
+    // derivatives of the mass balance equations, one sparse matrix per
+    // equation and unknown with the values written into a copy of the
+    // fixed pattern.
+    LinearisedBlackoilResidual
+    FullyImplicitCompressiblePolymerSolver::fullResidual() const
+    {
+        LinearisedBlackoilResidual full = residual_;
+        const int nc = grid_.number_of_cells;
+        const int nnz = block_cols_.size();
+        const std::vector<int>& bpat = residual_.material_balance_eq[0].blockPattern();
+        for (int eq = 0; eq < 3; ++eq) {
+            std::vector<M> jacs;
+            jacs.reserve(bpat.size());
+            for (int var = 0; var < 3; ++var) {
+                Eigen::SparseMatrix<double> jac(block_eq_jac_[3*eq + var]);
+                double* values = jac.valuePtr();
+                for (int k = 0; k < nnz; ++k) {
+                    values[k] = block_jac_[9*block_transpose_[k] + 3*eq + var];
+                }
+                jacs.push_back(M(std::move(jac)));
+            }
+            for (std::size_t block = 3; block < bpat.size(); ++block) {
+                jacs.push_back(M(nc, bpat[block]));
+            }
+            full.material_balance_eq[eq] += ADB::function(V::Zero(nc), std::move(jacs));
+        }
+        return full;
+    }
+
+
+
+
+
     V FullyImplicitCompressiblePolymerSolver::solveJacobianSystem() const
     {
-        return linsolver_.computeNewtonIncrement(residual_);
+        if (!block_assembly_) {
+            return linsolver_.computeNewtonIncrement(residual_);
+        }
+        if (block_linsolver_) {
+            const NewtonIterationPolymerCPR::BlockJacobian jac(3, block_rowptr_, block_cols_, block_jac_);
+            return block_linsolver_->computeNewtonIncrement(residual_, jac);
+        }
+        return linsolver_.computeNewtonIncrement(fullResidual());
+    }
+
+
+
+
+
+    // Solve for the unknowns of the given cells and the wells only,
+    // leaving the other cells unchanged. An empty set means all cells.
+    // Only used with the block assembly.
+    V FullyImplicitCompressiblePolymerSolver::solveJacobianSystem(const std::vector<int>& active_cells) const
+    {
+        if (active_cells.empty()) {
+            return solveJacobianSystem();
+        }
+        const std::vector<int>& bpat = residual_.material_balance_eq[0].blockPattern();
+        if (!block_linsolver_) {
+            const V dx = linsolver_.computeNewtonIncrement(restrictToCells(fullResidual(), active_cells, 3));
+            return extendFromCells(dx, active_cells, bpat, 3);
+        }
+        // The blocks coupling the active cells, renumbered, and the
+        // residual, which holds the well terms only, restricted to them.
+        std::vector<int> index(grid_.number_of_cells, -1);
+        for (std::size_t i = 0; i < active_cells.size(); ++i) {
+            index[active_cells[i]] = i;
+        }
+        std::vector<int> rowptr(1, 0);
+        std::vector<int> cols;
+        std::vector<double> values;
+        for (const int cell : active_cells) {
+            for (int k = block_rowptr_[cell]; k < block_rowptr_[cell + 1]; ++k) {
+                const int col = index[block_cols_[k]];
+                if (col >= 0) {
+                    cols.push_back(col);
+                    values.insert(values.end(), block_jac_.begin() + 9*k, block_jac_.begin() + 9*(k + 1));
+                }
+            }
+            rowptr.push_back(cols.size());
+        }
+        const NewtonIterationPolymerCPR::BlockJacobian jac(3, rowptr, cols, values);
+        const V dx = block_linsolver_->computeNewtonIncrement(restrictToCells(residual_, active_cells, 3), jac);
+        return extendFromCells(dx, active_cells, bpat, 3);
+    }
+
+
+
+
+
+    // Largest scaled change of a cell in the last update and of its
+    // residuals: relative pressure change, saturation change,
+    // concentration change relative to the maximum concentration, and
+    // residuals in saturation units as in the CNV measure.
+    V
+    FullyImplicitCompressiblePolymerSolver::cellChange(const double dt,
+                                                       const V& dx,
+                                                       const PolymerBlackoilState& state) const
+    {
+        const int nc = grid_.number_of_cells;
+        const V& pv = geo_.poreVolume();
+        const double c_scale = polymer_props_ad_.cMax() > 0.0 ? 1.0/polymer_props_ad_.cMax() : 1.0;
+        const V& bw = rq_[Water].b.value();
+        const V& bo = rq_[Oil].b.value();
+        const V& rw = residual_.material_balance_eq[0].value();
+        const V& ro = residual_.material_balance_eq[1].value();
+        const V& rc = residual_.material_balance_eq[2].value();
+        V change(nc);
+        for (int c = 0; c < nc; ++c) {
+            const double dp = std::abs(dx[c]) / std::max(std::abs(state.pressure()[c]), 1.0);
+            const double ds = std::abs(dx[nc + c]);
+            const double dc = std::abs(dx[2*nc + c]) * c_scale;
+            const double scale = dt / pv[c];
+            const double res = std::max(std::max(std::abs(rw[c]) / bw[c], std::abs(ro[c]) / bo[c]),
+                                        std::abs(rc[c]) / bw[c] * c_scale) * scale;
+            change[c] = std::max(std::max(dp, ds), std::max(dc, res));
+        }
+        return change;
     }
 
 
@@ -737,15 +1533,14 @@ namespace {
         assert(varstart == dx.size());
 
         // Pressure update.
-        const double dpmaxrel = 0.8;
         const V p_old = Eigen::Map<const V>(&state.pressure()[0], nc, 1);
-        const V absdpmax = dpmaxrel*p_old.abs();
+        const V absdpmax = dp_max_rel_*p_old.abs();
         const V dp_limited = sign(dp) * dp.abs().min(absdpmax);
         const V p = (p_old - dp_limited).max(zero);
         std::copy(&p[0], &p[0] + nc, state.pressure().begin());
 
         // Saturation updates.
-        const double dsmax = 0.3;
+        const double dsmax = ds_max_;
         const DataBlock s_old = Eigen::Map<const DataBlock>(&state.saturation()[0], nc, np);
         V so = one;
         const V sw_old = s_old.col(0);
@@ -757,13 +1552,10 @@ namespace {
             state.saturation()[c*np + 1] = so[c];
         }
 
-        // Concentration updates.
-//        const double dcmax = 0.3 * polymer_props_ad_.cMax();
-//		std::cout << "\n the max concentration: " << dcmax / 0.3 << std::endl;
+        // Concentration updates, limited to dc_max if positive.
         const V c_old = Eigen::Map<const V>(&state.concentration()[0], nc, 1);
-//        const V dc_limited = sign(dc) * dc.abs().min(dcmax);
-//        const V c = (c_old - dc_limited).max(zero);//unaryExpr(Chop02());
-        const V c = (c_old - dc).max(zero);
+        const V dc_limited = (dc_max_ > 0.0) ? V(sign(dc) * dc.abs().min(dc_max_)) : dc;
+        const V c = (c_old - dc_limited).max(zero);
         std::copy(&c[0], &c[0] + nc, state.concentration().begin());
 
         // Qs update.
@@ -836,12 +1628,10 @@ namespace {
 
 
     void
-    FullyImplicitCompressiblePolymerSolver::computeMassFlux(
-                                                 const V&                transi,
-                                                 const ADB&              mc,
-                                                 const ADB&              kro,
-                                                 const ADB&              krw_eff,
-                                                 const SolutionState&    state )
+    FullyImplicitCompressiblePolymerSolver::computeMobility(const ADB&              mc,
+                                                            const ADB&              kro,
+                                                            const ADB&              krw_eff,
+                                                            const SolutionState&    state )
     {
         const ADB tr_mult = transMult(state.pressure);
         const std::vector<PhasePresence> cond = phaseCondition();
@@ -854,6 +1644,24 @@ namespace {
         rq_[2].mob = tr_mult * mc * krw_eff * inv_wat_eff_vis;
         const ADB mu_o = fluidViscosity(1, press[1], temp, cond, cells_);
         rq_[1].mob = tr_mult * kro / mu_o;
+    }
+
+
+
+
+
+    void
+    FullyImplicitCompressiblePolymerSolver::computeMassFlux(
+                                                 const V&                transi,
+                                                 const ADB&              mc,
+                                                 const ADB&              kro,
+                                                 const ADB&              krw_eff,
+                                                 const SolutionState&    state )
+    {
+        computeMobility(mc, kro, krw_eff, state);
+        const std::vector<PhasePresence> cond = phaseCondition();
+		std::vector<ADB> press = computePressures(state);
+		const ADB& temp = state.temperature;
         for (int phase = 0; phase < 2; ++phase) {
             const ADB rho   = fluidDensity(phase, press[phase], temp, cond, cells_);
             ADB& head = rq_[ phase ].head;
@@ -897,6 +1705,99 @@ namespace {
 
 
 
+    std::vector<double>
+    FullyImplicitCompressiblePolymerSolver::equationNorms() const
+    {
+        std::vector<double> norms;
+        for (const ADB& eq : residual_.material_balance_eq) {
+            norms.push_back(eq.value().matrix().lpNorm<Eigen::Infinity>());
+        }
+        return norms;
+    }
+
+
+
+
+
+    bool
+    FullyImplicitCompressiblePolymerSolver::isConverged(const double dt,
+                                                        const double r,
+                                                        const double r0) const
+    {
+        if (tolerance_cnv_ <= 0.0 || tolerance_mb_ <= 0.0) {
+            return (r <= atol_) || (r <= rtol_*r0);
+        }
+
+        // Residuals in saturation units: each equation is scaled by
+        // dt and the average formation volume factor of its phase, the
+        // polymer equation also by the maximum concentration. CNV is
+        // the largest cell residual relative to the cell pore volume,
+        // MB the total residual relative to the total pore volume.
+        const V& pv = geo_.poreVolume();
+        const double pv_sum = pv.sum();
+        const double c_scale = polymer_props_ad_.cMax() > 0.0 ? 1.0/polymer_props_ad_.cMax() : 1.0;
+        const int nw = wells_.number_of_wells;
+        bool converged = true;
+        for (int eq = 0; eq < 3; ++eq) {
+            const int phase = (eq < 2) ? eq : Water;
+            double B_avg = rq_[phase].b.value().inverse().mean();
+            if (eq == 2) {
+                B_avg *= c_scale;
+            }
+            const V& R = residual_.material_balance_eq[eq].value();
+            const double cnv = B_avg * dt * (R.abs() / pv).maxCoeff();
+            const double mb = B_avg * dt * std::abs(R.sum()) / pv_sum;
+            converged = converged && (cnv < tolerance_cnv_) && (mb < tolerance_mb_);
+            if (eq < 2 && nw > 0) {
+                const V well_flux = residual_.well_flux_eq.value().segment(phase*nw, nw);
+                converged = converged && (B_avg * well_flux.abs().maxCoeff() < tolerance_wells_);
+            }
+        }
+        return converged;
+    }
+
+
+
+
+
+    void
+    FullyImplicitCompressiblePolymerSolver::
+    detectOscillations(const std::vector< std::vector<double> >& history,
+                       bool& oscillate,
+                       bool& stagnate) const
+    {
+        // The same criteria as BlackoilModelBase: the residuals oscillate
+        // if at least two equations return close to their value of two
+        // iterations ago after a significant change, and stagnate if no
+        // equation changed by more than 0.1%.
+        oscillate = false;
+        stagnate = false;
+        const int it = history.size() - 1;
+        if (it < 2 || relax_max_ >= 1.0) {
+            return;
+        }
+        stagnate = true;
+        int oscillating_eqs = 0;
+        for (std::size_t eq = 0; eq < history[it].size(); ++eq) {
+            const double f0 = history[it][eq];
+            const double f1 = history[it - 1][eq];
+            const double f2 = history[it - 2][eq];
+            if (f0 > 0.0) {
+                const double d1 = std::abs((f0 - f2) / f0);
+                const double d2 = std::abs((f0 - f1) / f0);
+                oscillating_eqs += (d1 < relax_rel_tol_) && (relax_rel_tol_ < d2);
+            }
+            if (f2 > 0.0 && std::abs((f1 - f2) / f2) > 1.0e-3) {
+                stagnate = false;
+            }
+        }
+        oscillate = (oscillating_eqs > 1);
+    }
+
+
+
+
+
     ADB
     FullyImplicitCompressiblePolymerSolver::fluidViscosity(const int                         phase,
 		                                                   const ADB&                        p    ,
@@ -904,7 +1805,7 @@ namespace {
                                                            const std::vector<PhasePresence>& cond,
            			                                       const std::vector<int>&           cells) const
     {
-        const ADB null = ADB::constant(V::Zero(grid_.number_of_cells, 1), p.blockPattern());
+        const ADB null = ADB::constant(V::Zero(cells.size(), 1), p.blockPattern());
         switch (phase) {
         case Water:
             return fluid_.muWat(p, T, cells);
@@ -927,7 +1828,7 @@ namespace {
                                                              const std::vector<PhasePresence>& cond,
                                                   		     const std::vector<int>&           cells) const
     {
-        const ADB null = ADB::constant(V::Zero(grid_.number_of_cells, 1), p.blockPattern());
+        const ADB null = ADB::constant(V::Zero(cells.size(), 1), p.blockPattern());
         switch (phase) {
         case Water:
             return fluid_.bWat(p, T, cells);
@@ -1096,11 +1997,8 @@ namespace {
         const double normNewState  = detail::euclidianNormSquared( current.pressure().begin(),   current.pressure().end())
                                    + detail::euclidianNormSquared( current.saturation().begin(), current.saturation().end());
 
-        if ( normNewState > 0.0 ) {
-            return normDiff / normNewState;
-        } else {
-            return 0.0;
-        }
+        const double relative_change = normNewState > 0.0 ? normDiff / normNewState : 0.0;
+        return front_change_.relativeChange(relative_change, previous, current, polymer_props_ad_.cMax());
     }
 
 } //namespace Opm
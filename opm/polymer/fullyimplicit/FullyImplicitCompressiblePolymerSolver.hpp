@@ -29,6 +29,7 @@
 #include <opm/polymer/PolymerProperties.hpp>
 #include <opm/polymer/fullyimplicit/WellStateFullyImplicitBlackoilPolymer.hpp>
 #include <opm/polymer/fullyimplicit/PolymerPropsAd.hpp>
+#include <opm/polymer/fullyimplicit/PolymerFrontChange.hpp>
 #include <opm/core/utility/parameters/ParameterGroup.hpp>
 
 struct UnstructuredGrid;
@@ -39,8 +40,10 @@ namespace Opm {
     class DerivedGeology;
     class RockCompressibility;
     class NewtonIterationBlackoilInterface;
+    class NewtonIterationPolymerCPR;
     class PolymerBlackoilState;
     class WellStateFullyImplicitBlackoil;
+    class PolymerInflowSchedule;
 
     /// A fully implicit solver for the oil-water with polymer problem.
     ///
@@ -63,13 +66,46 @@ namespace Opm {
         /// \param[in] polymer_props_ad polymer properties
         /// \param[in] wells            well structure
         /// \param[in] linsolver        linear solver
+        /// \param[in] param            solver parameters:
+        ///                             block_assembly (false) assemble the reservoir
+        ///                             equations from local 3x3 blocks instead of
+        ///                             through AutoDiffBlock operators. A linsolver of
+        ///                             type NewtonIterationPolymerCPR gets the blocks
+        ///                             directly, in the same storage every iteration.
+        ///                             block_assembly_check (0, off) if positive, also
+        ///                             assemble through the operators and throw if the
+        ///                             residuals or Jacobians of the block assembly differ
+        ///                             by more than this, relative to their magnitude.
+        ///                             newton_atol (1e-12), newton_rtol (5e-8) absolute
+        ///                             and relative tolerance of the residual norm.
+        ///                             max_iter (15) maximum number of Newton iterations.
+        ///                             tolerance_cnv (0), tolerance_mb (0) if both are
+        ///                             positive, converge on the scaled per cell (CNV)
+        ///                             and total (MB) residual of every equation instead,
+        ///                             with the scaled well fluxes below tolerance_wells (1e-3).
+        ///                             relax_max (0.5), relax_increment (0.1), relax_rel_tol (0.2)
+        ///                             damping of the updates on oscillation or stagnation.
+        ///                             dp_max_rel (0.8), ds_max (0.3), dc_max (0, off)
+        ///                             limits of the pressure (relative), saturation and
+        ///                             concentration updates.
+        ///                             active_set_tol (0, off) after each update, solve
+        ///                             only for the cells whose scaled update or residual
+        ///                             exceeds this tolerance, and their neighbours, and
+        ///                             reassemble only the rows of the updated cells and
+        ///                             their neighbours. Requires block_assembly.
+        ///                             timestep.control.saturation_change (0, off),
+        ///                             timestep.control.concentration_change (0, off)
+        ///                             targets of max |ds| and max |dc|/cmax per time step
+        ///                             for the adaptive time stepping, relative to its
+        ///                             tolerance timestep.control.tol (0.1).
         FullyImplicitCompressiblePolymerSolver(const UnstructuredGrid&         grid ,
         		                               const BlackoilPropsAdInterface& fluid,
                    			                   const DerivedGeology&           geo  ,
                               			       const RockCompressibility*      rock_comp_props,
                                     		   const PolymerPropsAd&           polymer_props_ad,
                                     		   const Wells&                    wells,
-                                    		   const NewtonIterationBlackoilInterface&    linsolver);
+                                    		   const NewtonIterationBlackoilInterface&    linsolver,
+                                               const parameter::ParameterGroup& param = parameter::ParameterGroup());
 
         /// Take a single forward step, modifiying
         ///   state.pressure()
@@ -80,7 +116,8 @@ namespace Opm {
         /// \param[in] dt        time step size
         /// \param[in] state     reservoir state
         /// \param[in] wstate    well state
-        /// \param[in] polymer_inflow	polymer influx
+        /// \return number of Newton iterations, throws NumericalProblem
+        ///         if the iterations do not converge.
         int
         step(const double   			dt,
              PolymerBlackoilState& 		state ,
@@ -89,13 +126,24 @@ namespace Opm {
         int nonlinearIterations() const;
         int linearIterations() const;
 
+        /// Take the polymer injection of every step from a schedule,
+        /// averaged over the step, instead of the concentrations in the
+        /// well state. The steps follow each other from the given start
+        /// time; a step that fails and is retried starts at the same time.
+        /// \param[in] schedule    polymer injection schedule, null for the well state
+        /// \param[in] start_time  start of the first step
+        void setPolymerInflow(const PolymerInflowSchedule* schedule,
+                              const double start_time);
+
         /// Not used by this class except to satisfy interface requirements.
         typedef parameter::ParameterGroup SolverParameters;
 
         /// There is no separate model class for this solver, return itself.
         const FullyImplicitCompressiblePolymerSolver& model() const;
 
-        /// Evaluate the relative changes in the physical variables.
+        /// Evaluate the relative changes in the physical variables,
+        /// raised to reflect the saturation and concentration change
+        /// targets when these are given.
         double relativeChange(const PolymerBlackoilState& previous,
                               const PolymerBlackoilState& current ) const;
 
@@ -160,7 +208,107 @@ namespace Opm {
         unsigned int newtonIterations_;
         unsigned int linearIterations_;
 
+        // Newton controls.
+        double atol_;
+        double rtol_;
+        int    max_iter_;
+        double tolerance_mb_;
+        double tolerance_cnv_;
+        double tolerance_wells_;
+        double relax_max_;
+        double relax_increment_;
+        double relax_rel_tol_;
+        double dp_max_rel_;
+        double ds_max_;
+        double dc_max_;
+        double active_set_tol_;
+        // Saturation and concentration change targets of the time steps.
+        PolymerFrontChange front_change_;
+        // Polymer injection schedule, if any, and the start of the next step.
+        const PolymerInflowSchedule* polymer_inflow_;
+        double inflow_time_;
+
+        // Block sparse storage of the reservoir Jacobian used by the
+        // block assembly. Each block couples the unknowns (p, sw, c) of
+        // two cells and is stored row major, equation by unknown.
+        bool                block_assembly_;
+        double              block_assembly_check_;
+        std::vector<int>    block_rowptr_;
+        std::vector<int>    block_cols_;
+        std::vector<int>    block_diag_;       // position of the diagonal block of each cell
+        std::vector<int>    block_face_;       // positions of (c1, c2) and (c2, c1) per internal face
+        std::vector<int>    block_transpose_;  // position of (j, i) for the block at (i, j)
+        std::vector<double> block_jac_;
+        // Values and derivatives with respect to the unknowns (p, sw, c)
+        // of its own cell of a cell quantity of the block assembly, one
+        // entry per cell.
+        struct CellDerivatives
+        {
+            void resize(const int n)
+            {
+                val = V::Zero(n);
+                for (int var = 0; var < 3; ++var) {
+                    d[var] = V::Zero(n);
+                }
+            }
+            void set(const int cell, const double value, const double* der)
+            {
+                val[cell] = value;
+                for (int var = 0; var < 3; ++var) {
+                    d[var][cell] = der[var];
+                }
+            }
+            V val;
+            V d[3];
+        };
+        // Cell quantities and reservoir residuals of the block assembly,
+        // kept through the Newton iterations of a step so that only
+        // the cells whose unknowns have changed are evaluated again.
+        struct BlockCellState
+        {
+            std::vector<CellDerivatives> acc;    // accumulation per equation
+            std::vector<CellDerivatives> bmob;   // b times mobility per equation
+            std::vector<CellDerivatives> press;  // phase pressures
+            std::vector<CellDerivatives> rho;    // phase densities
+            std::vector<CellDerivatives> b;      // phase b factors
+            std::vector<CellDerivatives> mob;    // phase mobilities
+            V                            mc;
+            std::vector<V>               res;    // residual per equation
+            double                       mu_w0;  // water viscosity of cell 0
+        };
+        BlockCellState      block_cells_;
+        // With the block assembly, the derivatives of the mass balance
+        // equations in residual_ with respect to the cell unknowns are
+        // those of the well terms only, the rest being block_jac_. The
+        // blocks go to block_linsolver_ (linsolver_, if it is a
+        // NewtonIterationPolymerCPR) as they are; other linear solvers
+        // get fullResidual().
+        const NewtonIterationPolymerCPR* block_linsolver_;
+        // Pattern of the reservoir Jacobian per equation and unknown,
+        // for fullResidual(), and the perforation-to-cell pattern of the
+        // perforation quantities, rebuilt when the perforated cells
+        // change.
+        std::vector< Eigen::SparseMatrix<double> > block_eq_jac_;
+        Eigen::SparseMatrix<double> perf_pattern_;
+        std::vector<int>    perf_pos_;
+        std::vector<int>    perf_cells_;
+
+        // Block pattern of the solution states, and the Jacobians of
+        // their primary variables in the order of the blocks, followed
+        // by that of the oil saturation. Built once and reused by every
+        // Newton iteration while the number of wells is unchanged.
+        std::vector<int>               state_bpat_;
+        std::vector< std::vector<M> >  state_jacs_;
+
         // Private methods.
+        const std::vector<int>&
+        stateBlockPattern(const WellStateFullyImplicitBlackoil& xw);
+
+        void
+        stateValues(const PolymerBlackoilState& x,
+                    const WellStateFullyImplicitBlackoil& xw,
+                    V& p, V& sw, V& c, V& qs, V& bhp) const;
+
         SolutionState
         constantState(const PolymerBlackoilState& x,
                       const WellStateFullyImplicitBlackoil&     xw);
@@ -177,10 +325,51 @@ namespace Opm {
         assemble(const double             	 dt,
                  const PolymerBlackoilState& x,
                  const WellStateFullyImplicitBlackoil& xw,  
-                 const std::vector<double>& polymer_inflow);
+                 const std::vector<double>& polymer_inflow,
+                 const std::vector<int>& changed_cells);
+
+        void
+        assembleOperators(const double             dt,
+                          const PolymerBlackoilState& x,
+                          const WellStateFullyImplicitBlackoil& xw,
+                          const std::vector<double>& polymer_inflow);
+
+        void
+        assembleBlocks(const double                dt,
+                       const PolymerBlackoilState& x,
+                       const WellStateFullyImplicitBlackoil& xw,
+                       const std::vector<double>& polymer_inflow,
+                       const std::vector<int>&     changed_cells);
+
+        void
+        checkBlockAssembly(const LinearisedBlackoilResidual& reference) const;
+
+        LinearisedBlackoilResidual
+        fullResidual() const;
+
+        void
+        buildBlockPattern();
+
+        void
+        buildPerfPattern(const std::vector<int>& well_cells);
+
+        void
+        assembleWellEq(const SolutionState&        state,
+                       const std::vector<ADB>&     perf_b,
+                       const std::vector<ADB>&     perf_mob,
+                       const V&                    perf_mc,
+                       const std::vector<V>&       perf_rho,
+                       const std::vector<double>&  polymer_inflow);
 
         V solveJacobianSystem() const;
 
+        V solveJacobianSystem(const std::vector<int>& active_cells) const;
+
+        V
+        cellChange(const double dt,
+                   const V& dx,
+                   const PolymerBlackoilState& state) const;
+
         void updateState(const V& dx,
                          PolymerBlackoilState& state,
                          WellStateFullyImplicitBlackoil& well_state) const;
@@ -197,6 +386,12 @@ namespace Opm {
                         const std::vector<ADB>& kr    ,
                         const SolutionState&    state );
 
+        void
+        computeMobility(const ADB&              mc,
+                        const ADB&              kro,
+                        const ADB&              krw_eff,
+                        const SolutionState&    state);
+
         void
         computeMassFlux(const V&                trans,
                         const ADB&              mc,
@@ -224,6 +419,17 @@ namespace Opm {
         double
         residualNorm() const;
 
+        std::vector<double>
+        equationNorms() const;
+
+        bool
+        isConverged(const double dt, const double r, const double r0) const;
+
+        void
+        detectOscillations(const std::vector< std::vector<double> >& history,
+                           bool& oscillate,
+                           bool& stagnate) const;
+
         ADB
         fluidViscosity(const int                         phase,
                        const ADB&                        p    ,
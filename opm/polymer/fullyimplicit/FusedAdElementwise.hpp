@@ -0,0 +1,165 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_FUSEDADELEMENTWISE_HEADER_INCLUDED
+#define OPM_FUSEDADELEMENTWISE_HEADER_INCLUDED
+
+#include <opm/autodiff/AutoDiffBlock.hpp>
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace Opm
+{
+
+    namespace detail
+    {
+        /// Diagonal of a Jacobian block if the block is square with
+        /// all its nonzeros on the diagonal, as identity and diagonal
+        /// blocks are. When the n nonzeros of an n-by-n block include
+        /// n nonzero diagonal entries there is nothing else.
+        /// \param[in]  m     Jacobian block
+        /// \param[out] diag  diagonal of m, valid if true is returned
+        /// \return           true if m is diagonal
+        inline bool diagonalBlock(const AutoDiffBlock<double>::M& m,
+                                  AutoDiffBlock<double>::V& diag)
+        {
+            const int n = m.rows();
+            if (m.cols() != n || m.nonZeros() != n) {
+                return false;
+            }
+            diag.resize(n);
+            for (int i = 0; i < n; ++i) {
+                diag[i] = m.coeff(i, i);
+                if (diag[i] == 0.0) {
+                    return false;
+                }
+            }
+            return true;
+        }
+    } // namespace detail
+
+
+
+    /// Evaluate an element-wise function of N AutoDiffBlock operands.
+    ///
+    /// A chain of element-wise operators such as a*b*c + d*e creates a
+    /// complete AutoDiffBlock, value and Jacobians, for every operator.
+    /// Here the whole chain is evaluated in one pass over the elements
+    /// that gives the value and the partial derivatives with respect
+    /// to each operand. The Jacobian of every block is then formed once
+    /// by the chain rule, sum_k diag(df/dx_k) J_k, skipping operands
+    /// that are constant or have an empty Jacobian in that block. The
+    /// terms of diagonal J_k are summed into one coefficient vector,
+    /// so a block with only diagonal terms is built as one diagonal
+    /// matrix; sparse products are formed only for sparse J_k.
+    ///
+    /// The function is called as f(i, x, dfdx) for every element i,
+    /// with x[k] the value of operand k. It must write the partial
+    /// derivatives to dfdx[k] and return the value.
+    ///
+    /// All operands must have the same size, and the non-constant
+    /// ones the same block pattern. The elements may be evaluated
+    /// concurrently, so f must not modify shared state.
+    template <std::size_t N, class Func>
+    AutoDiffBlock<double>
+    fusedElementwise(const std::array<const AutoDiffBlock<double>*, N>& args, Func f)
+    {
+        typedef AutoDiffBlock<double> ADB;
+        typedef ADB::V V;
+        typedef ADB::M M;
+
+        const int n = args[0]->size();
+
+        // Values and partial derivatives.
+        V val(n);
+        std::array<V, N> partial;
+        for (std::size_t k = 0; k < N; ++k) {
+            assert(args[k]->size() == n);
+            partial[k].resize(n);
+        }
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+        for (int i = 0; i < n; ++i) {
+            double x[N];
+            double dfdx[N];
+            for (std::size_t k = 0; k < N; ++k) {
+                x[k] = args[k]->value()[i];
+            }
+            val[i] = f(i, x, dfdx);
+            for (std::size_t k = 0; k < N; ++k) {
+                partial[k][i] = dfdx[k];
+            }
+        }
+
+        // Jacobians.
+        const std::vector<int>* bpat = 0;
+        for (std::size_t k = 0; k < N && !bpat; ++k) {
+            if (args[k]->numBlocks() > 0) {
+                bpat = &args[k]->blockPattern();
+            }
+        }
+        if (!bpat) {
+            return ADB::constant(std::move(val));
+        }
+        const int num_blocks = bpat->size();
+        std::vector<M> jacs;
+        jacs.reserve(num_blocks);
+        V diag_sum;
+        V dk_diag;
+        std::array<const M*, N> sparse_terms;
+        for (int block = 0; block < num_blocks; ++block) {
+            bool has_diag = false;
+            sparse_terms.fill(0);
+            for (std::size_t k = 0; k < N; ++k) {
+                if (args[k]->numBlocks() == 0) {
+                    continue;
+                }
+                assert(args[k]->numBlocks() == num_blocks);
+                const M& dk = args[k]->derivative()[block];
+                if (dk.nonZeros() == 0) {
+                    continue;
+                }
+                if (!detail::diagonalBlock(dk, dk_diag)) {
+                    sparse_terms[k] = &dk;
+                } else if (has_diag) {
+                    diag_sum += partial[k] * dk_diag;
+                } else {
+                    diag_sum = partial[k] * dk_diag;
+                    has_diag = true;
+                }
+            }
+            M jac = has_diag ? M(diag_sum.matrix().asDiagonal()) : M(n, (*bpat)[block]);
+            for (std::size_t k = 0; k < N; ++k) {
+                if (sparse_terms[k]) {
+                    jac = jac + M(partial[k].matrix().asDiagonal()) * (*sparse_terms[k]);
+                }
+            }
+            jacs.push_back(std::move(jac));
+        }
+        return ADB::function(std::move(val), std::move(jacs));
+    }
+
+} // namespace Opm
+
+#endif // OPM_FUSEDADELEMENTWISE_HEADER_INCLUDED
@@ -0,0 +1,170 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <config.h>
+
+#include <opm/polymer/fullyimplicit/LocalizedNewton.hpp>
+
+#include <cassert>
+#include <utility>
+
+namespace Opm
+{
+
+    typedef AutoDiffBlock<double> ADB;
+    typedef ADB::V V;
+    typedef ADB::M M;
+
+
+    namespace {
+
+        // Keep the rows (if cell_rows) and the cell block columns of
+        // the active cells. The entries are copied column by column, the
+        // active cells are in increasing order so the reduced matrix is
+        // filled in storage order. position[c] is the index of cell c
+        // among the active cells, or -1.
+        ADB restrictEquation(const ADB& eq,
+                             const bool cell_rows,
+                             const std::vector<int>& position,
+                             const std::vector<int>& cells,
+                             const int num_cell_blocks)
+        {
+            if (eq.numBlocks() == 0) {
+                return eq;
+            }
+            V val = cell_rows ? V(subset(eq.value(), cells)) : eq.value();
+            const int na = cells.size();
+            std::vector<M> jacs;
+            jacs.reserve(eq.numBlocks());
+            for (int block = 0; block < eq.numBlocks(); ++block) {
+                Eigen::SparseMatrix<double> jac;
+                eq.derivative()[block].toSparse(jac);
+                const bool cell_cols = block < num_cell_blocks;
+                const int rows = cell_rows ? na : jac.rows();
+                const int cols = cell_cols ? na : jac.cols();
+                Eigen::SparseMatrix<double> reduced(rows, cols);
+                reduced.reserve(jac.nonZeros());
+                for (int col = 0; col < cols; ++col) {
+                    reduced.startVec(col);
+                    const int full_col = cell_cols ? cells[col] : col;
+                    for (Eigen::SparseMatrix<double>::InnerIterator it(jac, full_col); it; ++it) {
+                        const int row = cell_rows ? position[it.row()] : it.row();
+                        if (row >= 0) {
+                            reduced.insertBack(row, col) = it.value();
+                        }
+                    }
+                }
+                reduced.finalize();
+                jacs.push_back(M(reduced));
+            }
+            return ADB::function(std::move(val), std::move(jacs));
+        }
+
+    } // anonymous namespace
+
+
+
+
+    std::vector<int> localizedActiveCells(const V& change,
+                                          const double tol,
+                                          const HelperOps& ops)
+    {
+        const int nc = change.size();
+        std::vector<char> active(nc, 0);
+        for (int c = 0; c < nc; ++c) {
+            active[c] = change[c] > tol;
+        }
+        const int ni = ops.internal_faces.size();
+        std::vector<char> with_nbrs = active;
+        for (int i = 0; i < ni; ++i) {
+            const int c1 = ops.nbi(i, 0);
+            const int c2 = ops.nbi(i, 1);
+            if (active[c1] || active[c2]) {
+                with_nbrs[c1] = 1;
+                with_nbrs[c2] = 1;
+            }
+        }
+        std::vector<int> cells;
+        for (int c = 0; c < nc; ++c) {
+            if (with_nbrs[c]) {
+                cells.push_back(c);
+            }
+        }
+        return cells;
+    }
+
+
+
+
+    LinearisedBlackoilResidual restrictToCells(const LinearisedBlackoilResidual& residual,
+                                               const std::vector<int>& cells,
+                                               const int num_cell_blocks)
+    {
+        const int nc = residual.material_balance_eq[0].size();
+        const int na = cells.size();
+        std::vector<int> position(nc, -1);
+        for (int k = 0; k < na; ++k) {
+            assert(k == 0 || cells[k] > cells[k - 1]);
+            position[cells[k]] = k;
+        }
+
+        LinearisedBlackoilResidual reduced = residual;
+        for (std::size_t eq = 0; eq < residual.material_balance_eq.size(); ++eq) {
+            reduced.material_balance_eq[eq] = restrictEquation(residual.material_balance_eq[eq], true,
+                                                               position, cells, num_cell_blocks);
+        }
+        reduced.well_flux_eq = restrictEquation(residual.well_flux_eq, false, position, cells, num_cell_blocks);
+        reduced.well_eq = restrictEquation(residual.well_eq, false, position, cells, num_cell_blocks);
+        return reduced;
+    }
+
+
+
+
+    V extendFromCells(const V& dx,
+                      const std::vector<int>& cells,
+                      const std::vector<int>& block_pattern,
+                      const int num_cell_blocks)
+    {
+        const int na = cells.size();
+        int size = 0;
+        for (const int block_size : block_pattern) {
+            size += block_size;
+        }
+        V full = V::Zero(size);
+        int start = 0;
+        int reduced_start = 0;
+        for (int block = 0; block < int(block_pattern.size()); ++block) {
+            if (block < num_cell_blocks) {
+                for (int k = 0; k < na; ++k) {
+                    full[start + cells[k]] = dx[reduced_start + k];
+                }
+                reduced_start += na;
+            } else {
+                full.segment(start, block_pattern[block]) = dx.segment(reduced_start, block_pattern[block]);
+                reduced_start += block_pattern[block];
+            }
+            start += block_pattern[block];
+        }
+        assert(reduced_start == dx.size());
+        return full;
+    }
+
+
+} // namespace Opm
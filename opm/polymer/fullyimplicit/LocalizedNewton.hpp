@@ -0,0 +1,77 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_LOCALIZEDNEWTON_HEADER_INCLUDED
+#define OPM_LOCALIZEDNEWTON_HEADER_INCLUDED
+
+#include <opm/autodiff/AutoDiffBlock.hpp>
+#include <opm/autodiff/AutoDiffHelpers.hpp>
+#include <opm/autodiff/LinearisedBlackoilResidual.hpp>
+
+#include <vector>
+
+namespace Opm
+{
+
+    // Helpers for localised Newton updates. After the first iterations
+    // of a time step, most cells away from the fronts have converged.
+    // Their unknowns are then kept fixed, and the Newton system is
+    // restricted to the remaining active cells and the well unknowns.
+    // The residual of the other cells must be kept up to date, which
+    // only requires reassembling the rows of the active cells and their
+    // neighbours, so the convergence check of the caller remains global
+    // and a cell whose residual grows again is reactivated.
+    //
+    // All functions expect the unknowns to be ordered as num_cell_blocks
+    // blocks of one unknown per cell, followed by the well unknowns, and
+    // the mass balance equations to have one row per cell.
+
+    /// Cells whose measure of change exceeds the tolerance, together
+    /// with their face neighbours, in increasing order.
+    /// \param[in] change  per cell measure, e.g. the largest scaled update or residual
+    /// \param[in] tol     tolerance below which a cell is considered converged
+    /// \param[in] ops     operators of the grid, giving the face neighbours
+    std::vector<int> localizedActiveCells(const AutoDiffBlock<double>::V& change,
+                                          const double tol,
+                                          const HelperOps& ops);
+
+    /// The Newton system restricted to the given cells: the mass
+    /// balance rows of the other cells and the Jacobian columns of
+    /// their unknowns are removed. The well equations are kept whole.
+    /// \param[in] residual         residual of all cells
+    /// \param[in] cells            active cells, in increasing order
+    /// \param[in] num_cell_blocks  number of unknown blocks defined per cell
+    LinearisedBlackoilResidual restrictToCells(const LinearisedBlackoilResidual& residual,
+                                               const std::vector<int>& cells,
+                                               const int num_cell_blocks);
+
+    /// Increment of all unknowns from that of the restricted system,
+    /// zero in the cells left out.
+    /// \param[in] dx               increment of the restricted system
+    /// \param[in] cells            active cells, in increasing order
+    /// \param[in] block_pattern    block sizes of the full system
+    /// \param[in] num_cell_blocks  number of unknown blocks defined per cell
+    AutoDiffBlock<double>::V extendFromCells(const AutoDiffBlock<double>::V& dx,
+                                             const std::vector<int>& cells,
+                                             const std::vector<int>& block_pattern,
+                                             const int num_cell_blocks);
+
+} // namespace Opm
+
+#endif // OPM_LOCALIZEDNEWTON_HEADER_INCLUDED
@@ -0,0 +1,766 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <config.h>
+
+#include <opm/polymer/fullyimplicit/NewtonIterationPolymerCPR.hpp>
+#include <opm/autodiff/AutoDiffHelpers.hpp>
+#include <opm/autodiff/DuneMatrix.hpp>
+#include <opm/autodiff/NewtonIterationUtilities.hpp>
+#include <opm/common/ErrorMacros.hpp>
+#include <opm/common/Exceptions.hpp>
+
+#include <dune/istl/bvector.hh>
+#include <dune/istl/bcrsmatrix.hh>
+#include <dune/istl/ilu.hh>
+#include <dune/istl/operators.hh>
+#include <dune/istl/preconditioners.hh>
+#include <dune/istl/solvers.hh>
+#include <dune/istl/paamg/amg.hh>
+
+#include <Eigen/Eigen>
+#include <Eigen/Sparse>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+namespace Opm
+{
+
+    typedef AutoDiffBlock<double> ADB;
+    typedef ADB::V V;
+
+    namespace
+    {
+
+        typedef Dune::FieldVector<double, 1   > VectorBlockType;
+        typedef Dune::FieldMatrix<double, 1, 1> MatrixBlockType;
+        typedef Dune::BCRSMatrix <MatrixBlockType>        Mat;
+        typedef Dune::BlockVector<VectorBlockType>        Vector;
+        typedef Dune::MatrixAdapter<Mat,Vector,Vector>    Operator;
+        typedef Eigen::SparseMatrix<double, Eigen::RowMajor> EigenMat;
+
+        // Position of the entry (row, col) in the storage of the
+        // compressed matrix A, which must have it.
+        int position(const EigenMat& A, const int row, const int col)
+        {
+            const int* begin = A.innerIndexPtr() + A.outerIndexPtr()[row];
+            const int* end = A.innerIndexPtr() + A.outerIndexPtr()[row + 1];
+            const int* pos = std::lower_bound(begin, end, col);
+            assert(pos != end && *pos == col);
+            return pos - A.innerIndexPtr();
+        }
+
+        // Copy values, in the storage order of a compressed matrix of the
+        // same pattern, into M.
+        void copyValues(const double* values, Mat& M)
+        {
+            for (Mat::RowIterator row = M.begin(); row != M.end(); ++row) {
+                for (Mat::ColIterator col = row->begin(); col != row->end(); ++col) {
+                    *col = *values++;
+                }
+            }
+        }
+
+        /// The polymer CPR preconditioner, see NewtonIterationPolymerCPR.
+        /// All stages are set up on construction, for one system, and
+        /// refreshed by update() for new values of the same pattern.
+        class PolymerCPRPreconditioner : public Dune::Preconditioner<Vector, Vector>
+        {
+        public:
+            typedef Dune::SeqILU0<Mat, Vector, Vector> Smoother;
+            typedef Dune::Amg::AMG<Operator, Vector, Smoother> AMG;
+
+            enum { category = Dune::SolverCategory::sequential };
+
+            PolymerCPRPreconditioner(const EigenMat& A,
+                                     const Mat& istlA,
+                                     const int num_eq,
+                                     const bool has_polymer,
+                                     const int polymer_sweeps);
+
+            ~PolymerCPRPreconditioner();
+
+            void update();
+
+            virtual void pre(Vector&, Vector&) {}
+
+            virtual void apply(Vector& v, const Vector& d);
+
+            virtual void post(Vector&) {}
+
+        private:
+            void computeImpesWeights();
+            void computePressureMatrix();
+            void setupPressureStage(const int num_eq);
+            void setupPolymerStage(const int num_eq);
+            void setupSmoother();
+            void factorSmoother();
+            void polymerSweeps(const Vector& r, Vector& x) const;
+
+            const EigenMat& A_;
+            const Mat& istlA_;
+            const int num_eq_;
+            const int nc_;
+            const bool has_polymer_;
+            const int polymer_sweeps_;
+            int c_offset_;
+            // Pressure stage: true-IMPES weights, num_phases per cell,
+            // the weighted pressure system with the position in it of each
+            // pressure entry of the phase equations, and its AMG.
+            int num_phases_;
+            std::vector<double> impes_weights_;
+            EigenMat Ap_;
+            std::vector<int> pressure_pos_;
+            std::unique_ptr<DuneMatrix> pressure_matrix_;
+            std::unique_ptr<Operator> pressure_operator_;
+            std::unique_ptr<AMG> amg_;
+            // Concentration stage: diagonal block of the polymer equation
+            // and the upwind cell order.
+            EigenMat Acc_;
+            std::vector<int> upwind_order_;
+            // Smoothing stage: ILU(0) of the full system with every
+            // diagonal entry present, factorised in place, with the
+            // positions of the entries of A and of the diagonal in it.
+            EigenMat As_;
+            std::vector<int> smoother_pos_;
+            std::vector<int> smoother_diag_;
+            std::unique_ptr<DuneMatrix> smoother_matrix_;
+        };
+
+    } // anonymous namespace
+
+
+
+
+    /// The system of the last solve: the reservoir matrix after the
+    /// elimination of the wells, its copy for dune-istl and the
+    /// preconditioner. The parts coming from the residual and from the
+    /// block matrix are added into A at fixed positions, computed when
+    /// their patterns change.
+    struct NewtonIterationPolymerCPR::PersistentSystem
+    {
+        // Pattern of the residual part, and of the block part if any.
+        std::vector<int> outer;
+        std::vector<int> inner;
+        int num_eq;
+        std::vector<int> block_rowptr;
+        std::vector<int> block_cols;
+        // Positions in A of the entries of the two parts.
+        std::vector<int> residual_pos;
+        std::vector<int> block_pos;
+        EigenMat A;
+        std::unique_ptr<DuneMatrix> istlA;
+        std::unique_ptr<PolymerCPRPreconditioner> precond;
+        // Iterations of the first solve after the preconditioner setup.
+        int setup_iterations;
+
+        PersistentSystem()
+            : num_eq(0), setup_iterations(0)
+        {
+        }
+
+        bool samePattern(const EigenMat& R, const BlockJacobian* jac) const
+        {
+            const int rows = R.rows();
+            if (R.cols() != A.cols() || rows != A.rows() || R.nonZeros() != int(inner.size())) {
+                return false;
+            }
+            if (!std::equal(outer.begin(), outer.end(), R.outerIndexPtr())
+                || !std::equal(inner.begin(), inner.end(), R.innerIndexPtr())) {
+                return false;
+            }
+            if (!jac) {
+                return block_rowptr.empty();
+            }
+            return jac->num_eq == num_eq && jac->rowptr == block_rowptr && jac->cols == block_cols;
+        }
+
+        void build(const EigenMat& R, const BlockJacobian* jac, const int eqs)
+        {
+            const int n = R.rows();
+            const int nc = n / eqs;
+            num_eq = eqs;
+            outer.assign(R.outerIndexPtr(), R.outerIndexPtr() + n + 1);
+            inner.assign(R.innerIndexPtr(), R.innerIndexPtr() + R.nonZeros());
+            block_rowptr.clear();
+            block_cols.clear();
+            typedef Eigen::Triplet<double> Tri;
+            std::vector<Tri> entries;
+            entries.reserve(R.nonZeros() + (jac ? jac->values.size() : 0));
+            for (int row = 0; row < n; ++row) {
+                for (EigenMat::InnerIterator it(R, row); it; ++it) {
+                    entries.push_back(Tri(row, it.col(), 0.0));
+                }
+            }
+            if (jac) {
+                block_rowptr = jac->rowptr;
+                block_cols = jac->cols;
+                for (int cell = 0; cell < nc; ++cell) {
+                    for (int k = block_rowptr[cell]; k < block_rowptr[cell + 1]; ++k) {
+                        for (int eq = 0; eq < num_eq; ++eq) {
+                            for (int var = 0; var < num_eq; ++var) {
+                                entries.push_back(Tri(eq*nc + cell, var*nc + block_cols[k], 0.0));
+                            }
+                        }
+                    }
+                }
+            }
+            A = EigenMat(n, n);
+            A.setFromTriplets(entries.begin(), entries.end());
+            A.makeCompressed();
+
+            residual_pos.resize(R.nonZeros());
+            for (int row = 0, k = 0; row < n; ++row) {
+                for (EigenMat::InnerIterator it(R, row); it; ++it, ++k) {
+                    residual_pos[k] = position(A, row, it.col());
+                }
+            }
+            block_pos.clear();
+            if (jac) {
+                block_pos.reserve(jac->values.size());
+                for (int cell = 0; cell < nc; ++cell) {
+                    for (int k = block_rowptr[cell]; k < block_rowptr[cell + 1]; ++k) {
+                        for (int eq = 0; eq < num_eq; ++eq) {
+                            for (int var = 0; var < num_eq; ++var) {
+                                block_pos.push_back(position(A, eq*nc + cell, var*nc + block_cols[k]));
+                            }
+                        }
+                    }
+                }
+            }
+            fill(R, jac);
+            istlA.reset(new DuneMatrix(A));
+        }
+
+        void fill(const EigenMat& R, const BlockJacobian* jac)
+        {
+            double* values = A.valuePtr();
+            std::fill(values, values + A.nonZeros(), 0.0);
+            const double* rvalues = R.valuePtr();
+            const int rnnz = residual_pos.size();
+            for (int k = 0; k < rnnz; ++k) {
+                values[residual_pos[k]] += rvalues[k];
+            }
+            const int bnnz = block_pos.size();
+            for (int k = 0; k < bnnz; ++k) {
+                values[block_pos[k]] += jac->values[k];
+            }
+        }
+    };
+
+
+
+
+    NewtonIterationPolymerCPR::NewtonIterationPolymerCPR(const parameter::ParameterGroup& param,
+                                                         const bool has_polymer)
+        : linear_solver_reduction_(param.getDefault("linear_solver_reduction", 1e-2)),
+          linear_solver_maxit_(param.getDefault("linear_solver_maxiter", 150)),
+          linear_solver_verbosity_(param.getDefault("linear_solver_verbosity", 0)),
+          polymer_sweeps_(std::max(param.getDefault("cpr_polymer_sweeps", 1), 1)),
+          has_polymer_(has_polymer),
+          reuse_setup_(param.getDefault("cpr_reuse_setup", true)),
+          iterations_(0)
+    {
+    }
+
+
+
+
+    NewtonIterationPolymerCPR::~NewtonIterationPolymerCPR()
+    {
+    }
+
+
+
+
+    NewtonIterationPolymerCPR::SolutionVector
+    NewtonIterationPolymerCPR::computeNewtonIncrement(const LinearisedBlackoilResidual& residual) const
+    {
+        return solve(residual, 0);
+    }
+
+
+
+
+    NewtonIterationPolymerCPR::SolutionVector
+    NewtonIterationPolymerCPR::computeNewtonIncrement(const LinearisedBlackoilResidual& residual,
+                                                      const BlockJacobian& jac) const
+    {
+        return solve(residual, &jac);
+    }
+
+
+
+
+    NewtonIterationPolymerCPR::SolutionVector
+    NewtonIterationPolymerCPR::solve(const LinearisedBlackoilResidual& residual,
+                                     const BlockJacobian* jac) const
+    {
+        // Eliminate the well unknowns, as in NewtonIterationBlackoilCPR.
+        const int num_eq = residual.material_balance_eq.size();
+        std::vector<ADB> eqs;
+        eqs.reserve(num_eq + 2);
+        for (int eq = 0; eq < num_eq; ++eq) {
+            eqs.push_back(residual.material_balance_eq[eq]);
+        }
+        const bool has_wells = residual.well_flux_eq.size() > 0;
+        std::vector<ADB> elim_eqs;
+        if (has_wells) {
+            eqs.push_back(residual.well_flux_eq);
+            eqs.push_back(residual.well_eq);
+            elim_eqs.reserve(2);
+            elim_eqs.push_back(eqs[num_eq]);
+            eqs = eliminateVariable(eqs, num_eq); // Eliminate well flux unknowns.
+            elim_eqs.push_back(eqs[num_eq]);
+            eqs = eliminateVariable(eqs, num_eq); // Eliminate well bhp unknowns.
+        }
+        assert(int(eqs.size()) == num_eq);
+
+        const ADB total_residual = vertcatCollapseJacs(eqs);
+        EigenMat R;
+        total_residual.derivative()[0].toSparse(R);
+        R.makeCompressed();
+        const int n = R.rows();
+        const int nc = n / num_eq;
+        if (nc * num_eq != n || R.cols() != n) {
+            OPM_THROW(std::logic_error, "NewtonIterationPolymerCPR requires one unknown block per equation.");
+        }
+        if (jac && (jac->num_eq != num_eq || int(jac->rowptr.size()) != nc + 1
+                    || int(jac->values.size()) != num_eq * num_eq * jac->rowptr[nc])) {
+            OPM_THROW(std::logic_error, "NewtonIterationPolymerCPR: block Jacobian does not match the residual.");
+        }
+
+        // The matrix, in place if the pattern is that of the last system.
+        const bool same_pattern = reuse_setup_ && system_ && system_->samePattern(R, jac);
+        if (same_pattern) {
+            system_->fill(R, jac);
+            copyValues(system_->A.valuePtr(), *system_->istlA);
+        } else {
+            system_.reset(new PersistentSystem());
+            system_->build(R, jac, num_eq);
+        }
+        PersistentSystem& sys = *system_;
+
+        // Create ISTL right hand side.
+        Operator opA(*sys.istlA);
+        const V& b = total_residual.value();
+        Vector istlb(n);
+        for (int i = 0; i < n; ++i) {
+            istlb[i] = b[i];
+        }
+        Vector x(n);
+
+        // Refresh the preconditioner unless a new setup is due.
+        bool new_setup = !same_pattern || iterations_ > 2 * sys.setup_iterations;
+        if (!new_setup) {
+            sys.precond->update();
+        }
+        Dune::InverseOperatorResult result;
+        for (;;) {
+            if (new_setup) {
+                sys.precond.reset();
+                sys.precond.reset(new PolymerCPRPreconditioner(sys.A, *sys.istlA, num_eq,
+                                                               has_polymer_, polymer_sweeps_));
+            }
+            x = 0.0;
+            Vector rhs(istlb);
+            Dune::BiCGSTABSolver<Vector> linsolve(opA, *sys.precond, linear_solver_reduction_,
+                                                  linear_solver_maxit_, linear_solver_verbosity_);
+            linsolve.apply(x, rhs, result);
+            if (result.converged || new_setup) {
+                break;
+            }
+            // Retry once with a new setup before giving up.
+            new_setup = true;
+        }
+        iterations_ = result.iterations;
+        if (new_setup) {
+            sys.setup_iterations = std::max(iterations_, 1);
+        }
+        if (!result.converged) {
+            OPM_THROW(LinearSolverProblem, "Polymer CPR linear solver failed to converge.");
+        }
+
+        SolutionVector dx(SolutionVector::Zero(n));
+        for (int i = 0; i < n; ++i) {
+            dx[i] = x[i][0];
+        }
+        if (!dx.allFinite()) {
+            OPM_THROW(LinearSolverProblem, "Polymer CPR linear solver produced a non-finite solution.");
+        }
+        if (has_wells) {
+            // Recovery in inverse order of elimination.
+            dx = recoverVariable(elim_eqs[1], dx, num_eq);
+            dx = recoverVariable(elim_eqs[0], dx, num_eq);
+        }
+        return dx;
+    }
+
+
+
+
+    const boost::any& NewtonIterationPolymerCPR::parallelInformation() const
+    {
+        return parallelInformation_;
+    }
+
+
+
+
+    PolymerCPRPreconditioner::PolymerCPRPreconditioner(const EigenMat& A,
+                                                       const Mat& istlA,
+                                                       const int num_eq,
+                                                       const bool has_polymer,
+                                                       const int polymer_sweeps)
+        : A_(A),
+          istlA_(istlA),
+          num_eq_(num_eq),
+          nc_(A.rows() / num_eq),
+          has_polymer_(has_polymer),
+          polymer_sweeps_(polymer_sweeps),
+          c_offset_(0),
+          num_phases_(0)
+    {
+        setupPressureStage(num_eq);
+        if (has_polymer_) {
+            setupPolymerStage(num_eq);
+        }
+        setupSmoother();
+    }
+
+
+
+
+    PolymerCPRPreconditioner::~PolymerCPRPreconditioner()
+    {
+        // Release the vectors of the AMG hierarchy.
+        Vector x(nc_);
+        amg_->post(x);
+    }
+
+
+
+
+    // New values of A with the same pattern: the AMG keeps its
+    // aggregates and recomputes the Galerkin products of the coarse
+    // levels, the other stages are computed anew in their storage.
+    void PolymerCPRPreconditioner::update()
+    {
+        computeImpesWeights();
+        computePressureMatrix();
+        copyValues(Ap_.valuePtr(), *pressure_matrix_);
+        amg_->recalculateHierarchy();
+        if (has_polymer_) {
+            setupPolymerStage(num_eq_);
+        }
+        factorSmoother();
+    }
+
+
+
+
+    // Weights combining the phase equations so as to remove, cell by
+    // cell, the diagonal coupling to the other phase unknowns
+    // (true-IMPES weights).
+    void PolymerCPRPreconditioner::computeImpesWeights()
+    {
+        const int nc = nc_;
+        const int np = num_phases_;
+        impes_weights_.assign(np * nc, 1.0);
+        Eigen::MatrixXd B(np, np);
+        Eigen::VectorXd e0 = Eigen::VectorXd::Zero(np);
+        e0[0] = 1.0;
+        for (int cell = 0; cell < nc; ++cell) {
+            for (int eq = 0; eq < np; ++eq) {
+                for (int var = 0; var < np; ++var) {
+                    B(eq, var) = A_.coeff(eq*nc + cell, var*nc + cell);
+                }
+            }
+            const Eigen::VectorXd w = B.transpose().fullPivLu().solve(e0);
+            if (w.allFinite() && (B.transpose() * w - e0).norm() < 1e-8) {
+                for (int eq = 0; eq < np; ++eq) {
+                    impes_weights_[cell*np + eq] = w[eq];
+                }
+            }
+        }
+    }
+
+
+
+
+    // Values of the pressure system from the weighted phase equations.
+    void PolymerCPRPreconditioner::computePressureMatrix()
+    {
+        const int nc = nc_;
+        const int np = num_phases_;
+        double* values = Ap_.valuePtr();
+        std::fill(values, values + Ap_.nonZeros(), 0.0);
+        int k = 0;
+        for (int eq = 0; eq < np; ++eq) {
+            for (int cell = 0; cell < nc; ++cell) {
+                const double w = impes_weights_[cell*np + eq];
+                for (EigenMat::InnerIterator it(A_, eq*nc + cell); it; ++it) {
+                    if (it.col() < nc) {
+                        values[pressure_pos_[k++]] += w * it.value();
+                    }
+                }
+            }
+        }
+    }
+
+
+
+
+    // Pressure system from the combination of the phase equations
+    // with the true-IMPES weights, and its AMG.
+    void PolymerCPRPreconditioner::setupPressureStage(const int num_eq)
+    {
+        const int nc = nc_;
+        num_phases_ = has_polymer_ ? num_eq - 1 : num_eq;
+        const int np = num_phases_;
+        computeImpesWeights();
+
+        std::vector< Eigen::Triplet<double> > triplets;
+        triplets.reserve(np * A_.nonZeros() / num_eq);
+        for (int eq = 0; eq < np; ++eq) {
+            for (int cell = 0; cell < nc; ++cell) {
+                for (EigenMat::InnerIterator it(A_, eq*nc + cell); it; ++it) {
+                    if (it.col() < nc) {
+                        triplets.push_back(Eigen::Triplet<double>(cell, it.col(), 0.0));
+                    }
+                }
+            }
+        }
+        Ap_ = EigenMat(nc, nc);
+        Ap_.setFromTriplets(triplets.begin(), triplets.end());
+        Ap_.makeCompressed();
+        pressure_pos_.resize(triplets.size());
+        for (std::size_t k = 0; k < triplets.size(); ++k) {
+            pressure_pos_[k] = position(Ap_, triplets[k].row(), triplets[k].col());
+        }
+        computePressureMatrix();
+        pressure_matrix_.reset(new DuneMatrix(Ap_));
+        pressure_operator_.reset(new Operator(*pressure_matrix_));
+
+        // Aggregation AMG, with the criterion of CPRPreconditioner.
+        typedef Dune::Amg::CoarsenCriterion<Dune::Amg::SymmetricCriterion<Mat, Dune::Amg::FirstDiagonal> > Criterion;
+        Criterion criterion(15, 2000);
+        criterion.setDefaultValuesIsotropic(2);
+        criterion.setDebugLevel(0);
+        Dune::Amg::SmootherTraits<Smoother>::Arguments smoother_args;
+        smoother_args.iterations = 1;
+        smoother_args.relaxationFactor = 1.0;
+        amg_.reset(new AMG(*pressure_operator_, criterion, smoother_args));
+        Vector x(nc);
+        Vector rhs(nc);
+        x = 0.0;
+        rhs = 0.0;
+        amg_->pre(x, rhs);
+    }
+
+
+
+
+    // Diagonal block of the polymer equation, and the order of the
+    // cells along the upwind direction. An upwind discretisation only
+    // couples a cell to the concentration of its upstream neighbours,
+    // so the off-diagonal entries of row i give the edges j -> i.
+    void PolymerCPRPreconditioner::setupPolymerStage(const int num_eq)
+    {
+        const int nc = nc_;
+        c_offset_ = (num_eq - 1) * nc;
+        Acc_ = A_.block(c_offset_, c_offset_, nc, nc);
+        Acc_.makeCompressed();
+        const EigenMat AccT = Acc_.transpose();
+
+        // Topological sort, breaking cycles at the lowest remaining cell.
+        std::vector<int> indegree(nc, 0);
+        for (int cell = 0; cell < nc; ++cell) {
+            for (EigenMat::InnerIterator it(Acc_, cell); it; ++it) {
+                if (it.col() != cell && it.value() != 0.0) {
+                    ++indegree[cell];
+                }
+            }
+        }
+        std::vector<int> queue;
+        queue.reserve(nc);
+        for (int cell = 0; cell < nc; ++cell) {
+            if (indegree[cell] == 0) {
+                queue.push_back(cell);
+            }
+        }
+        std::vector<bool> done(nc, false);
+        upwind_order_.clear();
+        upwind_order_.reserve(nc);
+        std::size_t head = 0;
+        int next_unvisited = 0;
+        while (int(upwind_order_.size()) < nc) {
+            if (head == queue.size()) {
+                while (done[next_unvisited]) {
+                    ++next_unvisited;
+                }
+                queue.push_back(next_unvisited);
+            }
+            const int cell = queue[head++];
+            if (done[cell]) {
+                continue;
+            }
+            done[cell] = true;
+            upwind_order_.push_back(cell);
+            for (EigenMat::InnerIterator it(AccT, cell); it; ++it) {
+                const int down = it.col();
+                if (down != cell && it.value() != 0.0 && --indegree[down] == 0 && !done[down]) {
+                    queue.push_back(down);
+                }
+            }
+        }
+    }
+
+
+
+
+    // ILU(0) of the full reservoir system, with every diagonal entry
+    // present in the pattern.
+    void PolymerCPRPreconditioner::setupSmoother()
+    {
+        const int n = A_.rows();
+        EigenMat I(n, n);
+        I.setIdentity();
+        As_ = A_ + 0.0 * I;
+        As_.makeCompressed();
+        smoother_pos_.resize(A_.nonZeros());
+        for (int row = 0, k = 0; row < n; ++row) {
+            for (EigenMat::InnerIterator it(A_, row); it; ++it, ++k) {
+                smoother_pos_[k] = position(As_, row, it.col());
+            }
+        }
+        smoother_diag_.resize(n);
+        for (int row = 0; row < n; ++row) {
+            smoother_diag_[row] = position(As_, row, row);
+        }
+        smoother_matrix_.reset(new DuneMatrix(As_));
+        factorSmoother();
+    }
+
+
+
+
+    // Factorise the ILU(0) in place. A vanishing diagonal (e.g. the
+    // polymer equation of a cell without water) is replaced by one,
+    // leaving that unknown to the other stages.
+    void PolymerCPRPreconditioner::factorSmoother()
+    {
+        double* values = As_.valuePtr();
+        std::fill(values, values + As_.nonZeros(), 0.0);
+        const double* avalues = A_.valuePtr();
+        const int nnz = smoother_pos_.size();
+        for (int k = 0; k < nnz; ++k) {
+            values[smoother_pos_[k]] = avalues[k];
+        }
+        for (const int pos : smoother_diag_) {
+            if (values[pos] == 0.0) {
+                values[pos] = 1.0;
+            }
+        }
+        copyValues(values, *smoother_matrix_);
+        Dune::bilu0_decomposition(*smoother_matrix_);
+    }
+
+
+
+
+    void PolymerCPRPreconditioner::polymerSweeps(const Vector& r, Vector& x) const
+    {
+        x = 0.0;
+        for (int sweep = 0; sweep < polymer_sweeps_; ++sweep) {
+            for (const int cell : upwind_order_) {
+                double sum = r[cell][0];
+                double diag = 0.0;
+                for (EigenMat::InnerIterator it(Acc_, cell); it; ++it) {
+                    if (it.col() == cell) {
+                        diag = it.value();
+                    } else {
+                        sum -= it.value() * x[it.col()][0];
+                    }
+                }
+                if (diag != 0.0) {
+                    x[cell] = sum / diag;
+                }
+            }
+        }
+    }
+
+
+
+
+    void PolymerCPRPreconditioner::apply(Vector& v, const Vector& d)
+    {
+        const int nc = nc_;
+        const int np = num_phases_;
+        v = 0.0;
+
+        // Pressure stage.
+        Vector rp(nc);
+        rp = 0.0;
+        for (int cell = 0; cell < nc; ++cell) {
+            for (int eq = 0; eq < np; ++eq) {
+                rp[cell] += impes_weights_[cell*np + eq] * d[eq*nc + cell][0];
+            }
+        }
+        Vector dp(nc);
+        dp = 0.0;
+        amg_->apply(dp, rp);
+        for (int cell = 0; cell < nc; ++cell) {
+            v[cell] = dp[cell];
+        }
+
+        // Concentration stage, with the pressure correction in place.
+        if (has_polymer_) {
+            Vector rc(nc);
+            for (int cell = 0; cell < nc; ++cell) {
+                double r = d[c_offset_ + cell][0];
+                for (EigenMat::InnerIterator it(A_, c_offset_ + cell); it; ++it) {
+                    if (it.col() < nc) {
+                        r -= it.value() * v[it.col()][0];
+                    }
+                }
+                rc[cell] = r;
+            }
+            Vector dc(nc);
+            polymerSweeps(rc, dc);
+            for (int cell = 0; cell < nc; ++cell) {
+                v[c_offset_ + cell] += dc[cell];
+            }
+        }
+
+        // Smoothing of the full system.
+        Vector res(d);
+        istlA_.mmv(v, res);
+        Vector dv(v.size());
+        dv = 0.0;
+        Dune::bilu_backsolve(*smoother_matrix_, dv, res);
+        v += dv;
+    }
+
+
+} // namespace Opm
@@ -0,0 +1,143 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_NEWTONITERATIONPOLYMERCPR_HEADER_INCLUDED
+#define OPM_NEWTONITERATIONPOLYMERCPR_HEADER_INCLUDED
+
+#include <opm/autodiff/NewtonIterationBlackoilInterface.hpp>
+#include <opm/core/utility/parameters/ParameterGroup.hpp>
+
+#include <boost/any.hpp>
+
+#include <memory>
+#include <vector>
+
+namespace Opm
+{
+
+    /// Linear solver for the Newton systems of the fully implicit
+    /// polymer models, with a two-stage CPR preconditioner aware of
+    /// the polymer concentration equation.
+    ///
+    /// The well unknowns are eliminated first. The reservoir system is
+    /// expected to have one unknown block per mass balance equation,
+    /// in the same order, with pressure first and, when polymer is
+    /// present, the concentration last (true for both
+    /// FullyImplicitCompressiblePolymerSolver and BlackoilPolymerModel).
+    /// The preconditioner applies, in sequence:
+    ///  - a pressure correction from the true-IMPES combination of the
+    ///    phase equations, one AMG cycle as in NewtonIterationBlackoilCPR,
+    ///  - a concentration correction from the polymer equation with all
+    ///    other unknowns frozen, solved by Gauss-Seidel sweeps over the
+    ///    cells ordered along the upwind direction (one sweep is exact
+    ///    when the upwind graph is acyclic),
+    ///  - an ILU(0) smoothing step on the full system.
+    /// It preconditions the BiCGStab solver of dune-istl.
+    ///
+    /// The matrices and the preconditioner setup are kept from one system
+    /// to the next as long as the sparsity pattern is unchanged, as over
+    /// the Newton iterations of a time step. The values are then written
+    /// in place, the ILU(0) is refactorised in place and the AMG keeps its
+    /// aggregates, only recomputing its coarse level matrices. The
+    /// smoothers and the coarse solver of the AMG keep the factorisations
+    /// of the last full setup. That setup is redone when the pattern
+    /// changes, when the iteration count doubles relative to the first
+    /// solve after the setup, or when a solve with a reused setup fails.
+    class NewtonIterationPolymerCPR : public NewtonIterationBlackoilInterface
+    {
+    public:
+        /// Reservoir Jacobian in block compressed sparse row format: one
+        /// block row per cell, the blocks of cell i having the column
+        /// cells cols[rowptr[i]] to cols[rowptr[i + 1] - 1], and each
+        /// block num_eq x num_eq values, stored row major (equation by
+        /// unknown). The vectors are referenced, not copied.
+        struct BlockJacobian
+        {
+            BlockJacobian(const int                  num_eq_arg,
+                          const std::vector<int>&    rowptr_arg,
+                          const std::vector<int>&    cols_arg,
+                          const std::vector<double>& values_arg)
+                : num_eq(num_eq_arg), rowptr(rowptr_arg), cols(cols_arg), values(values_arg)
+            {
+            }
+            int num_eq;
+            const std::vector<int>& rowptr;
+            const std::vector<int>& cols;
+            const std::vector<double>& values;
+        };
+
+        /// Construct a solver.
+        /// The following parameters are used:
+        ///   linear_solver_reduction (default 1e-2)  relative residual reduction
+        ///   linear_solver_maxiter   (default 150)   maximum number of iterations
+        ///   linear_solver_verbosity (default 0)     verbosity of the dune-istl solver
+        ///   cpr_polymer_sweeps      (default 1)     Gauss-Seidel sweeps of the concentration stage
+        ///   cpr_reuse_setup         (default true)  keep matrices and preconditioner setup
+        ///                                           while the sparsity pattern is unchanged
+        /// \param[in] param         parameters controlling the solver
+        /// \param[in] has_polymer   whether the last equation is the polymer equation
+        NewtonIterationPolymerCPR(const parameter::ParameterGroup& param,
+                                  const bool has_polymer);
+
+        ~NewtonIterationPolymerCPR();
+
+        /// Solve the system of linear equations Ax = b, with A being the
+        /// combined derivative matrix of the residual and b
+        /// being the residual itself.
+        /// \param[in] residual   residual object containing A and b.
+        /// \return               the solution x
+        virtual SolutionVector computeNewtonIncrement(const LinearisedBlackoilResidual& residual) const;
+
+        /// Solve the system of linear equations Ax = b as above, with the
+        /// derivatives of the mass balance equations with respect to the
+        /// cell unknowns being the sum of those of the residual and of the
+        /// block matrix jac. Passing the same block pattern each time lets
+        /// the solver write the values into its matrices in place.
+        /// \param[in] residual   residual object containing b and part of A.
+        /// \param[in] jac        the rest of the reservoir part of A.
+        /// \return               the solution x
+        SolutionVector computeNewtonIncrement(const LinearisedBlackoilResidual& residual,
+                                              const BlockJacobian& jac) const;
+
+        /// \copydoc NewtonIterationBlackoilInterface::iterations
+        virtual int iterations() const { return iterations_; }
+
+        /// \copydoc NewtonIterationBlackoilInterface::parallelInformation
+        virtual const boost::any& parallelInformation() const;
+
+    private:
+        struct PersistentSystem;
+
+        SolutionVector solve(const LinearisedBlackoilResidual& residual,
+                             const BlockJacobian* jac) const;
+
+        double linear_solver_reduction_;
+        int linear_solver_maxit_;
+        int linear_solver_verbosity_;
+        int polymer_sweeps_;
+        bool has_polymer_;
+        bool reuse_setup_;
+        mutable int iterations_;
+        mutable std::unique_ptr<PersistentSystem> system_;
+        boost::any parallelInformation_;
+    };
+
+} // namespace Opm
+
+#endif // OPM_NEWTONITERATIONPOLYMERCPR_HEADER_INCLUDED
@@ -0,0 +1,136 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <config.h>
+
+#include <opm/polymer/fullyimplicit/NewtonIterationPolymerTransport.hpp>
+#include <opm/autodiff/AutoDiffHelpers.hpp>
+#include <opm/autodiff/DuneMatrix.hpp>
+#include <opm/common/ErrorMacros.hpp>
+#include <opm/common/Exceptions.hpp>
+
+#include <dune/istl/bvector.hh>
+#include <dune/istl/bcrsmatrix.hh>
+#include <dune/istl/operators.hh>
+#include <dune/istl/preconditioners.hh>
+#include <dune/istl/solvers.hh>
+
+#include <Eigen/Eigen>
+#include <Eigen/Sparse>
+
+#include <vector>
+
+namespace Opm
+{
+
+    typedef AutoDiffBlock<double> ADB;
+    typedef ADB::V V;
+
+    namespace
+    {
+        typedef Dune::FieldVector<double, 1   > VectorBlockType;
+        typedef Dune::FieldMatrix<double, 1, 1> MatrixBlockType;
+        typedef Dune::BCRSMatrix <MatrixBlockType>        Mat;
+        typedef Dune::BlockVector<VectorBlockType>        Vector;
+        typedef Dune::MatrixAdapter<Mat,Vector,Vector>    Operator;
+        typedef Eigen::SparseMatrix<double, Eigen::RowMajor> EigenMat;
+    } // anonymous namespace
+
+
+
+
+    NewtonIterationPolymerTransport::NewtonIterationPolymerTransport(const parameter::ParameterGroup& param)
+        : linear_solver_reduction_(param.getDefault("transport_linear_solver_reduction", 1e-3)),
+          linear_solver_maxit_(param.getDefault("transport_linear_solver_maxiter", 100)),
+          linear_solver_verbosity_(param.getDefault("linear_solver_verbosity", 0)),
+          iterations_(0)
+    {
+    }
+
+
+
+
+    NewtonIterationPolymerTransport::SolutionVector
+    NewtonIterationPolymerTransport::computeNewtonIncrement(const LinearisedBlackoilResidual& residual) const
+    {
+        if (residual.well_flux_eq.size() > 0 || residual.well_eq.size() > 0) {
+            OPM_THROW(std::logic_error, "NewtonIterationPolymerTransport does not handle well equations.");
+        }
+        const ADB total_residual = vertcatCollapseJacs(residual.material_balance_eq);
+        EigenMat A;
+        total_residual.derivative()[0].toSparse(A);
+        const int n = A.rows();
+        if (A.cols() != n) {
+            OPM_THROW(std::logic_error, "NewtonIterationPolymerTransport requires a square system.");
+        }
+
+        // ISTL matrix and right hand side.
+        DuneMatrix istlA(A);
+        Operator opA(istlA);
+        const V& b = total_residual.value();
+        Vector istlb(n);
+        for (int i = 0; i < n; ++i) {
+            istlb[i] = b[i];
+        }
+        Vector x(n);
+        x = 0.0;
+
+        // ILU(0) preconditioner, with every diagonal entry present and
+        // vanishing ones replaced by one.
+        EigenMat I(n, n);
+        I.setIdentity();
+        EigenMat As = A + 0.0 * I;
+        for (int row = 0; row < n; ++row) {
+            double& diag = As.coeffRef(row, row);
+            if (diag == 0.0) {
+                diag = 1.0;
+            }
+        }
+        DuneMatrix precond_matrix(As);
+        Dune::SeqILU0<Mat, Vector, Vector> precond(precond_matrix, 1.0);
+
+        Dune::BiCGSTABSolver<Vector> linsolve(opA, precond, linear_solver_reduction_,
+                                              linear_solver_maxit_, linear_solver_verbosity_);
+        Dune::InverseOperatorResult result;
+        linsolve.apply(x, istlb, result);
+        iterations_ = result.iterations;
+        if (!result.converged) {
+            OPM_THROW(LinearSolverProblem, "Polymer transport linear solver failed to converge.");
+        }
+
+        SolutionVector dx(SolutionVector::Zero(n));
+        for (int i = 0; i < n; ++i) {
+            dx[i] = x[i][0];
+        }
+        if (!dx.allFinite()) {
+            OPM_THROW(LinearSolverProblem, "Polymer transport linear solver produced a non-finite solution.");
+        }
+        return dx;
+    }
+
+
+
+
+    const boost::any& NewtonIterationPolymerTransport::parallelInformation() const
+    {
+        return parallelInformation_;
+    }
+
+
+} // namespace Opm
@@ -0,0 +1,75 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_NEWTONITERATIONPOLYMERTRANSPORT_HEADER_INCLUDED
+#define OPM_NEWTONITERATIONPOLYMERTRANSPORT_HEADER_INCLUDED
+
+#include <opm/autodiff/NewtonIterationBlackoilInterface.hpp>
+#include <opm/core/utility/parameters/ParameterGroup.hpp>
+
+#include <boost/any.hpp>
+
+namespace Opm
+{
+
+    /// Linear solver for the transport systems of the sequential split
+    /// of BlackoilPolymerModel: saturation, rs/rv and concentration
+    /// unknowns with pressure and wells frozen.
+    ///
+    /// These systems are dominated by the upwind fluxes and the
+    /// accumulation terms, and have no elliptic part for an AMG to act
+    /// on. They are solved by the BiCGStab solver of dune-istl with an
+    /// ILU(0) preconditioner. A vanishing diagonal, e.g. of the polymer
+    /// equation in a cell without water, is replaced by one in the
+    /// preconditioner. The residual must not have well equations.
+    class NewtonIterationPolymerTransport : public NewtonIterationBlackoilInterface
+    {
+    public:
+        /// Construct a solver.
+        /// The following parameters are used:
+        ///   transport_linear_solver_reduction (default 1e-3)  relative residual reduction
+        ///   transport_linear_solver_maxiter   (default 100)   maximum number of iterations
+        ///   linear_solver_verbosity           (default 0)     verbosity of the dune-istl solver
+        /// \param[in] param         parameters controlling the solver
+        explicit NewtonIterationPolymerTransport(const parameter::ParameterGroup& param);
+
+        /// Solve the system of linear equations Ax = b, with A being the
+        /// combined derivative matrix of the residual and b
+        /// being the residual itself.
+        /// \param[in] residual   residual object containing A and b.
+        /// \return               the solution x
+        virtual SolutionVector computeNewtonIncrement(const LinearisedBlackoilResidual& residual) const;
+
+        /// \copydoc NewtonIterationBlackoilInterface::iterations
+        virtual int iterations() const { return iterations_; }
+
+        /// \copydoc NewtonIterationBlackoilInterface::parallelInformation
+        virtual const boost::any& parallelInformation() const;
+
+    private:
+        double linear_solver_reduction_;
+        int linear_solver_maxit_;
+        int linear_solver_verbosity_;
+        mutable int iterations_;
+        boost::any parallelInformation_;
+    };
+
+} // namespace Opm
+
+#endif // OPM_NEWTONITERATIONPOLYMERTRANSPORT_HEADER_INCLUDED
@@ -0,0 +1,100 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <config.h>
+
+#include <opm/polymer/fullyimplicit/PolymerFrontChange.hpp>
+#include <opm/polymer/PolymerBlackoilState.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+namespace Opm
+{
+
+    namespace
+    {
+        double maxAbsDifference(const std::vector<double>& a,
+                                const std::vector<double>& b)
+        {
+            assert(a.size() == b.size());
+            double diff = 0.0;
+            for (std::size_t i = 0; i < a.size(); ++i) {
+                diff = std::max(diff, std::abs(a[i] - b[i]));
+            }
+            return diff;
+        }
+    } // anonymous namespace
+
+
+
+
+    PolymerFrontChange::PolymerFrontChange()
+        : control_tol_(0.0),
+          saturation_change_(0.0),
+          concentration_change_(0.0)
+    {
+    }
+
+
+
+
+    PolymerFrontChange::PolymerFrontChange(const double control_tol,
+                                           const double saturation_change,
+                                           const double concentration_change)
+        : control_tol_(control_tol),
+          saturation_change_(std::max(saturation_change, 0.0)),
+          concentration_change_(std::max(concentration_change, 0.0))
+    {
+    }
+
+
+
+
+    bool PolymerFrontChange::active() const
+    {
+        return control_tol_ > 0.0 && (saturation_change_ > 0.0 || concentration_change_ > 0.0);
+    }
+
+
+
+
+    double PolymerFrontChange::relativeChange(const double relative_change,
+                                              const PolymerBlackoilState& previous,
+                                              const PolymerBlackoilState& current,
+                                              const double cmax) const
+    {
+        if (!active()) {
+            return relative_change;
+        }
+        double front = 0.0;
+        if (saturation_change_ > 0.0) {
+            front = std::max(front, maxAbsDifference(previous.saturation(), current.saturation())
+                             / saturation_change_);
+        }
+        if (concentration_change_ > 0.0 && cmax > 0.0) {
+            front = std::max(front, maxAbsDifference(previous.concentration(), current.concentration())
+                             / (cmax * concentration_change_));
+        }
+        return std::max(relative_change, control_tol_ * front);
+    }
+
+} // namespace Opm
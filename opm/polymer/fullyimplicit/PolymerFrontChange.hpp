@@ -0,0 +1,74 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_POLYMERFRONTCHANGE_HEADER_INCLUDED
+#define OPM_POLYMERFRONTCHANGE_HEADER_INCLUDED
+
+namespace Opm
+{
+
+    class PolymerBlackoilState;
+
+    /// Targets for the change of saturation and polymer concentration
+    /// over a time step, used by the adaptive time stepping of the
+    /// fully implicit polymer simulators.
+    ///
+    /// The time step controls of AdaptiveTimeStepping that use the
+    /// relative change of the solution ("pid" and "pid+iteration")
+    /// aim at a relative change equal to their tolerance. The change
+    /// of the state norm is dominated by pressure and hardly notices
+    /// a polymer slug moving through a few cells, so the models also
+    /// measure the largest local changes, max |ds| and max |dc|/cmax,
+    /// against these targets. That measure, scaled to the tolerance
+    /// of the control, replaces the relative change when it is larger.
+    class PolymerFrontChange
+    {
+    public:
+        /// No targets, the relative change is left as it is.
+        PolymerFrontChange();
+
+        /// \param[in] control_tol           tolerance of the time step control
+        /// \param[in] saturation_change     target of max |ds|, zero when not used
+        /// \param[in] concentration_change  target of max |dc|/cmax, zero when not used
+        PolymerFrontChange(const double control_tol,
+                           const double saturation_change,
+                           const double concentration_change);
+
+        /// Whether any target is set.
+        bool active() const;
+
+        /// The relative change to give to the time step control.
+        /// \param[in] relative_change  relative change of the state norm
+        /// \param[in] previous         state at the start of the step
+        /// \param[in] current          state at the end of the step
+        /// \param[in] cmax             maximum polymer concentration
+        double relativeChange(const double relative_change,
+                              const PolymerBlackoilState& previous,
+                              const PolymerBlackoilState& current,
+                              const double cmax) const;
+
+    private:
+        double control_tol_;
+        double saturation_change_;
+        double concentration_change_;
+    };
+
+} // namespace Opm
+
+#endif // OPM_POLYMERFRONTCHANGE_HEADER_INCLUDED
@@ -31,6 +31,35 @@ namespace Opm {
     typedef PolymerPropsAd::V V;
 
 
+    namespace {
+
+        /// Jacobians of f(c) by the chain rule, diag(df/dc) times the
+        /// Jacobians of c. When c is a primary variable all but one of
+        /// its blocks are empty, those are passed on as empty blocks of
+        /// the same size without forming a product. If df/dc vanishes,
+        /// as for adsorption below the historical maximum, all blocks
+        /// are empty.
+        std::vector<ADB::M> chainRule(const V& df, const ADB& c)
+        {
+            const int num_blocks = c.numBlocks();
+            std::vector<ADB::M> jacs;
+            jacs.reserve(num_blocks);
+            const bool zero_derivative = (df == 0.0).all();
+            const ADB::M df_diag(df.matrix().asDiagonal());
+            for (int block = 0; block < num_blocks; ++block) {
+                const ADB::M& dc = c.derivative()[block];
+                if (zero_derivative || dc.nonZeros() == 0) {
+                    jacs.push_back(ADB::M(dc.rows(), dc.cols()));
+                } else {
+                    jacs.push_back(df_diag * dc);
+                }
+            }
+            return jacs;
+        }
+
+    } // anonymous namespace
+
+
 
 
 
@@ -118,11 +147,20 @@ namespace Opm {
         return polymer_props_.viscMult(c);
     }
 
+    const PolymerProperties&
+    PolymerPropsAd::polymerProperties() const
+    {
+        return polymer_props_;
+    }
+
     V
     PolymerPropsAd::viscMult(const V& c) const
     {
         int nc = c.size();
         V visc_mult(nc);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
         for (int i = 0; i < nc; ++i) {
             visc_mult[i] = polymer_props_.viscMult(c[i]);
         }
@@ -154,6 +192,9 @@ namespace Opm {
     {
         const int nc = c.size();
         V inv_mu_w_eff(nc);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
         for (int i = 0; i < nc; ++i) {
             double im = 0;
             polymer_props_.effectiveInvVisc(c(i), visc, im);
@@ -173,18 +214,16 @@ namespace Opm {
 	    const int nc = c.size();
     	V inv_mu_w_eff(nc);
     	V dinv_mu_w_eff(nc);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
     	for (int i = 0; i < nc; ++i) {
     	    double im = 0, dim = 0;
     	    polymer_props_.effectiveInvViscWithDer(c.value()(i), visc, im, dim);
     	    inv_mu_w_eff(i) = im;
     	    dinv_mu_w_eff(i) = dim;
     	}
-        ADB::M dim_diag(dinv_mu_w_eff.matrix().asDiagonal());
-        const int num_blocks = c.numBlocks();
-        std::vector<ADB::M> jacs(num_blocks);
-        for (int block = 0; block < num_blocks; ++block) {
-            jacs[block] = dim_diag * c.derivative()[block];
-        }
+        std::vector<ADB::M> jacs = chainRule(dinv_mu_w_eff, c);
         return ADB::function(std::move(inv_mu_w_eff), std::move(jacs));
     }
 
@@ -197,6 +236,9 @@ namespace Opm {
         const int nc = c.size();
         V mc(nc);
 
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
         for (int i = 0; i < nc; ++i) {
             double m = 0;
             polymer_props_.computeMc(c(i), m);
@@ -217,6 +259,9 @@ namespace Opm {
         V mc(nc);
         V dmc(nc);
         
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
         for (int i = 0; i < nc; ++i) {
             double m = 0;
             double dm = 0;
@@ -226,12 +271,7 @@ namespace Opm {
             dmc(i) = dm;
         }
 
-        ADB::M dmc_diag(dmc.matrix().asDiagonal());
-        const int num_blocks = c.numBlocks();
-        std::vector<ADB::M> jacs(num_blocks);
-        for (int block = 0; block < num_blocks; ++block) {
-            jacs[block] = dmc_diag * c.derivative()[block];
-        }
+        std::vector<ADB::M> jacs = chainRule(dmc, c);
 
         return ADB::function(std::move(mc), std::move(jacs));
     }
@@ -245,6 +285,9 @@ namespace Opm {
         const int nc = c.size();
         V ads(nc);
 
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
         for (int i = 0; i < nc; ++i) {
             double c_ads = 0;
             polymer_props_.adsorption(c(i), cmax_cells(i), c_ads);
@@ -266,6 +309,9 @@ namespace Opm {
         V ads(nc);
         V dads(nc);
 
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
         for (int i = 0; i < nc; ++i) {
             double c_ads = 0;
             double dc_ads = 0;
@@ -274,12 +320,7 @@ namespace Opm {
             dads(i) = dc_ads;
         }
 
-        ADB::M dads_diag(dads.matrix().asDiagonal());
-        int num_blocks = c.numBlocks();
-        std::vector<ADB::M> jacs(num_blocks);
-        for (int block = 0; block < num_blocks; ++block) {
-            jacs[block] = dads_diag * c.derivative()[block];
-        }
+        std::vector<ADB::M> jacs = chainRule(dads, c);
 
         return ADB::function(std::move(ads), std::move(jacs));
     }
@@ -315,16 +356,39 @@ namespace Opm {
                                      const ADB& krw) const
     {
         const int nc = c.value().size();
-        V one = V::Ones(nc);
-        ADB ads = adsorption(c, cmax_cells);
-        V krw_eff = effectiveRelPerm(c.value(), cmax_cells.value(), krw.value());
+        const ADB ads = adsorption(c, cmax_cells);
 
         double max_ads = polymer_props_.cMaxAds();
         double res_factor = polymer_props_.resFactor();
         double factor = (res_factor - 1.) / max_ads;
-        ADB rk = one + ads * factor; 
-        
-        return krw / rk;
+
+        // krw / rk with rk = 1 + factor * ads, without the intermediate rk.
+        V krw_eff(nc);
+        V dkrw(nc);
+        V dads(nc);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+        for (int i = 0; i < nc; ++i) {
+            const double inv_rk = 1.0 / (1.0 + factor * ads.value()(i));
+            krw_eff(i) = krw.value()(i) * inv_rk;
+            dkrw(i) = inv_rk;
+            dads(i) = -krw_eff(i) * factor * inv_rk;
+        }
+        std::vector<ADB::M> jacs = chainRule(dkrw, krw);
+        if (ads.numBlocks() > 0) {
+            const std::vector<ADB::M> jacs_ads = chainRule(dads, ads);
+            if (jacs.empty()) {
+                jacs = jacs_ads;
+            } else {
+                for (std::size_t block = 0; block < jacs.size(); ++block) {
+                    if (jacs_ads[block].nonZeros() > 0) {
+                        jacs[block] = jacs[block] + jacs_ads[block];
+                    }
+                }
+            }
+        }
+        return ADB::function(std::move(krw_eff), std::move(jacs));
     }
 
 
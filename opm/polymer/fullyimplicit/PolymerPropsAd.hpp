@@ -67,6 +67,10 @@ namespace Opm {
 
         double viscMult(double c) const; // multipler interpolated from PLYVISC table
 
+        /// \return    The wrapped polymer properties, for evaluation
+        ///            cell by cell with derivatives.
+        const PolymerProperties& polymerProperties() const;
+
 		typedef AutoDiffBlock<double> ADB;
         typedef ADB::V V;
 
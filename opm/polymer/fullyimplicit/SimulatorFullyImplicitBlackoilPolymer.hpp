@@ -24,6 +24,7 @@
 #include <opm/autodiff/SimulatorBase.hpp>
 #include <opm/autodiff/SimulatorFullyImplicitBlackoilOutput.hpp>
 #include <opm/polymer/fullyimplicit/BlackoilPolymerModel.hpp>
+#include <opm/polymer/fullyimplicit/NewtonIterationPolymerTransport.hpp>
 #include <opm/polymer/fullyimplicit/WellStateFullyImplicitBlackoilPolymer.hpp>
 #include <opm/polymer/PolymerBlackoilState.hpp>
 #include <opm/polymer/PolymerInflow.hpp>
@@ -64,6 +65,7 @@
 #include <boost/lexical_cast.hpp>
 
 #include <algorithm>
+#include <array>
 #include <cstddef>
 #include <cassert>
 #include <functional>
@@ -140,15 +142,39 @@ namespace Opm
         // flag for SHRATE keyword
         bool has_shrate_;
         DeckConstPtr deck_;
+        // pressure-transport passes of the sequential split, zero for fully
+        // implicit, and the linear solver of its transport stage
+        int sequential_iterations_;
+        std::unique_ptr<NewtonIterationPolymerTransport> transport_linsolver_;
+        // solve the well equations locally in every Newton iteration
+        bool local_well_solve_;
+        // relative tolerance for reusing perforation shear factors, zero when off
+        double shear_cache_tol_;
+        // saturation and concentration change targets of the adaptive time steps
+        PolymerFrontChange front_change_;
 
         std::vector<double> wells_rep_radius_;
         std::vector<double> wells_perf_length_;
         std::vector<double> wells_bore_diameter_;
 
+        // dense mapping from Cartesian grid cells to compressed cells, -1 for
+        // cells not in the grid, and the dimensions of the perforated cells,
+        // kept between report steps for computeRepRadiusPerfLength()
+        std::vector<int> cartesian_to_compressed_;
+        std::unordered_map<int, std::array<double, 3> > perf_cell_dims_;
+
+        // polymer injection of all report steps, built at the first
+        // report step when the deck has WPOLYMER
+        std::unique_ptr<PolymerInflowSchedule> polymer_inflow_;
+        // start time of the current report step, where the first substep
+        // of the solver begins
+        double report_step_start_;
+
         // generate the mapping from Cartesian grid cells to global compressed cells,
-        // copied from opm-core, to be used in function computeRepRadiusPerfLength()
+        // to be used in function computeRepRadiusPerfLength()
         static void
-        setupCompressedToCartesian(const int* global_cell, int number_of_cells, std::map<int,int>& cartesian_to_compressed);
+        setupCompressedToCartesian(const int* global_cell, int number_of_cells, int cartesian_size,
+                                   std::vector<int>& cartesian_to_compressed);
 
         //  calculate the representative radius and length for for well peforations
         //  and store the wellbore diameters
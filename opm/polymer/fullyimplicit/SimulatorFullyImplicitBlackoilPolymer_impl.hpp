@@ -57,7 +57,25 @@ namespace Opm
         , has_plyshlog_(has_plyshlog)
         , has_shrate_(has_shrate)
         , deck_(deck)
+        , sequential_iterations_(param.getDefault("sequential_iterations", 0))
+        , local_well_solve_(param.getDefault("local_well_solve", false))
+        , shear_cache_tol_(param.getDefault("shear_cache_tol", 0.0))
+        , front_change_(param.getDefault("timestep.control.tol", 1.0e-1),
+                        param.getDefault("timestep.control.saturation_change", 0.0),
+                        param.getDefault("timestep.control.concentration_change", 0.0))
+        , report_step_start_(0.0)
     {
+        if (sequential_iterations_ > 0) {
+            transport_linsolver_.reset(new NewtonIterationPolymerTransport(param));
+        }
+        // A table of polymer concentrations over time replaces WPOLYMER when given.
+        const std::string poly_schedule_file = param.getDefault("poly_schedule_file", std::string(""));
+        if (!poly_schedule_file.empty()) {
+            const bool linear = param.getDefault("poly_schedule_linear", true);
+            polymer_inflow_.reset(new PolymerInflowSchedule(poly_schedule_file,
+                                                            linear ? PolymerInflowSchedule::Linear
+                                                                   : PolymerInflowSchedule::Stepwise));
+        }
     }
 
     template <class GridT>
@@ -90,6 +108,11 @@ namespace Opm
         if (!BaseType::threshold_pressures_by_face_.empty()) {
             model->setThresholdPressures(BaseType::threshold_pressures_by_face_);
         }
+        model->setSequentialSplit(sequential_iterations_, transport_linsolver_.get());
+        model->setLocalWellSolve(local_well_solve_);
+        model->setShearCacheTolerance(shear_cache_tol_);
+        model->setFrontChangeTargets(front_change_);
+        model->setPolymerInflow(polymer_inflow_.get(), report_step_start_);
 
         return std::unique_ptr<Solver>(new Solver(BaseType::solver_param_, std::move(model)));
     }
@@ -104,23 +127,26 @@ namespace Opm
                                     typename BaseType::WellState& well_state,
                                     const Wells* wells)
     {
-        // compute polymer inflow
-        std::unique_ptr<PolymerInflowInterface> polymer_inflow_ptr;
-        if (deck_->hasKeyword("WPOLYMER")) {
+        // compute polymer inflow, per perforation, averaged over the report step;
+        // the solver re-evaluates it over each of its substeps
+        std::vector<double>& perf_polymer_inflow = well_state.perfPolymerInflow();
+        report_step_start_ = timer.simulationTimeElapsed();
+        if (!polymer_inflow_ && deck_->hasKeyword("WPOLYMER")) {
             if (wells_manager.c_wells() == 0) {
                 OPM_THROW(std::runtime_error, "Cannot control polymer injection via WPOLYMER without wells.");
             }
-            polymer_inflow_ptr.reset(new PolymerInflowFromDeck(deck_, BaseType::eclipse_state_, *wells, Opm::UgGridHelpers::numCells(BaseType::grid_), timer.currentStepNum()));
+            // The WPOLYMER timeline of the schedule is read once; each report
+            // step only looks up the concentrations of its wells.
+            polymer_inflow_.reset(new PolymerInflowSchedule(BaseType::eclipse_state_));
+        }
+        if (polymer_inflow_ && wells) {
+            polymer_inflow_->getPerfInflowValues(timer.simulationTimeElapsed(),
+                                                 timer.simulationTimeElapsed() + timer.currentStepLength(),
+                                                 *wells, perf_polymer_inflow);
         } else {
-            polymer_inflow_ptr.reset(new PolymerInflowBasic(0.0*Opm::unit::day,
-                                                            1.0*Opm::unit::day,
-                                                            0.0));
+            const int nperf = wells ? wells->well_connpos[wells->number_of_wells] : 0;
+            perf_polymer_inflow.assign(nperf, 0.0);
         }
-        std::vector<double> polymer_inflow_c(Opm::UgGridHelpers::numCells(BaseType::grid_));
-        polymer_inflow_ptr->getInflowValues(timer.simulationTimeElapsed(),
-                                            timer.simulationTimeElapsed() + timer.currentStepLength(),
-                                            polymer_inflow_c);
-        well_state.polymerInflow() = polymer_inflow_c;
 
         computeRepRadiusPerfLength(BaseType::eclipse_state_, timer.currentStepNum(), BaseType::grid_, wells_rep_radius_, wells_perf_length_, wells_bore_diameter_);
     }
@@ -128,17 +154,18 @@ namespace Opm
 
     template <class GridT>
     void SimulatorFullyImplicitBlackoilPolymer<GridT>::
-    setupCompressedToCartesian(const int* global_cell, int number_of_cells,
-                               std::map<int,int>& cartesian_to_compressed )
+    setupCompressedToCartesian(const int* global_cell, int number_of_cells, int cartesian_size,
+                               std::vector<int>& cartesian_to_compressed )
     {
+        cartesian_to_compressed.assign(cartesian_size, -1);
         if (global_cell) {
             for (int i = 0; i < number_of_cells; ++i) {
-                cartesian_to_compressed.insert(std::make_pair(global_cell[i], i));
+                cartesian_to_compressed[global_cell[i]] = i;
             }
         }
         else {
             for (int i = 0; i < number_of_cells; ++i) {
-                cartesian_to_compressed.insert(std::make_pair(i, i));
+                cartesian_to_compressed[i] = i;
             }
         }
 
@@ -155,8 +182,10 @@ namespace Opm
                                std::vector<double>&            wells_bore_diameter)
     {
 
-        // TODO, the function does not work for parallel running
-        // to be fixed later.
+        // The Cartesian index and the dimensions of the perforated cells
+        // are kept between report steps, so only the completions are
+        // walked here. Completions in cells that are not part of this
+        // (possibly distributed) grid are skipped, as in the wells.
         int number_of_cells = Opm::UgGridHelpers::numCells(grid);
         const int* global_cell = Opm::UgGridHelpers::globalCell(grid);
         const int* cart_dims = Opm::UgGridHelpers::cartDims(grid);
@@ -179,10 +208,12 @@ namespace Opm
         wells_perf_length.reserve(n_perf);
         wells_bore_diameter.reserve(n_perf);
 
-        std::map<int,int> cartesian_to_compressed;
-
-        setupCompressedToCartesian(global_cell, number_of_cells,
-                                   cartesian_to_compressed);
+        const int cartesian_size = cart_dims[0] * cart_dims[1] * cart_dims[2];
+        if (int(cartesian_to_compressed_.size()) != cartesian_size) {
+            setupCompressedToCartesian(global_cell, number_of_cells, cartesian_size,
+                                       cartesian_to_compressed_);
+            perf_cell_dims_.clear();
+        }
 
         ScheduleConstPtr          schedule = eclipseState->getSchedule();
         std::vector<WellConstPtr> wells    = schedule->getWells(timeStep);
@@ -206,12 +237,14 @@ namespace Opm
 
                          const int* cpgdim = cart_dims;
                          int cart_grid_indx = i + cpgdim[0]*(j + cpgdim[1]*k);
-                         std::map<int, int>::const_iterator cgit = cartesian_to_compressed.find(cart_grid_indx);
-                         if (cgit == cartesian_to_compressed.end()) {
+                         if (cart_grid_indx < 0 || cart_grid_indx >= cartesian_size) {
                              OPM_THROW(std::runtime_error, "Cell with i,j,k indices " << i << ' ' << j << ' '
                                        << k << " not found in grid (well = " << well->name() << ')');
                          }
-                         int cell = cgit->second;
+                         const int cell = cartesian_to_compressed_[cart_grid_indx];
+                         if (cell < 0) {
+                             continue;
+                         }
 
                          {
                              double radius = 0.5*completion->getDiameter();
@@ -220,8 +253,12 @@ namespace Opm
                                  OPM_MESSAGE("**** Warning: Well bore internal radius set to " << radius);
                              }
 
-                             const std::array<double, 3> cubical =
-                             WellsManagerDetail::getCubeDim<3>(cell_to_faces, begin_face_centroids, cell);
+                             auto dims = perf_cell_dims_.find(cell);
+                             if (dims == perf_cell_dims_.end()) {
+                                 dims = perf_cell_dims_.insert(std::make_pair(cell,
+                                     WellsManagerDetail::getCubeDim<3>(cell_to_faces, begin_face_centroids, cell))).first;
+                             }
+                             const std::array<double, 3>& cubical = dims->second;
 
                              WellCompletion::DirectionEnum direction = completion->getDirection();
 
@@ -62,6 +62,7 @@
 #include <boost/scoped_ptr.hpp>
 #include <boost/lexical_cast.hpp>
 
+#include <memory>
 #include <numeric>
 #include <fstream>
 #include <iostream>
@@ -118,6 +119,12 @@ namespace Opm
 private:
         Opm::DeckConstPtr deck_;
         const PolymerPropsAd& polymer_props_;
+        // polymer injection of all report steps, built at the first
+        // report step when the deck has WPOLYMER
+        std::unique_ptr<PolymerInflowSchedule> polymer_inflow_;
+        // start time of the current report step, where the first substep
+        // of the solver begins
+        double report_step_start_;
     };
 
 } // namespace Opm
@@ -51,8 +51,16 @@ SimulatorFullyImplicitCompressiblePolymer(const parameter::ParameterGroup& param
            /*threshold_pressures_by_face=*/std::vector<double>())
     , deck_(deck)
     , polymer_props_(polymer_props)
-
+    , report_step_start_(0.0)
 {
+    // A table of polymer concentrations over time replaces WPOLYMER when given.
+    const std::string poly_schedule_file = param.getDefault("poly_schedule_file", std::string(""));
+    if (!poly_schedule_file.empty()) {
+        const bool linear = param.getDefault("poly_schedule_linear", true);
+        polymer_inflow_.reset(new PolymerInflowSchedule(poly_schedule_file,
+                                                        linear ? PolymerInflowSchedule::Linear
+                                                               : PolymerInflowSchedule::Stepwise));
+    }
 }
 
 template <class GridT>
@@ -60,13 +68,16 @@ auto SimulatorFullyImplicitCompressiblePolymer<GridT>::
 createSolver(const Wells* wells)
     -> std::unique_ptr<Solver>
 {
-    return std::unique_ptr<Solver>(new Solver(BaseType::grid_,
-                                              BaseType::props_,
-                                              BaseType::geo_,
-                                              BaseType::rock_comp_props_,
-                                              polymer_props_,
-                                              *wells,
-                                              BaseType::solver_));
+    auto solver = std::unique_ptr<Solver>(new Solver(BaseType::grid_,
+                                                     BaseType::props_,
+                                                     BaseType::geo_,
+                                                     BaseType::rock_comp_props_,
+                                                     polymer_props_,
+                                                     *wells,
+                                                     BaseType::solver_,
+                                                     BaseType::model_param_));
+    solver->setPolymerInflow(polymer_inflow_.get(), report_step_start_);
+    return solver;
 }
 
 template <class GridT>
@@ -76,23 +87,26 @@ handleAdditionalWellInflow(SimulatorTimer& timer,
                            typename BaseType::WellState& well_state,
                            const Wells* wells)
 {
-    // compute polymer inflow
-    std::unique_ptr<PolymerInflowInterface> polymer_inflow_ptr;
-    if (deck_->hasKeyword("WPOLYMER")) {
+    // compute polymer inflow, per perforation, averaged over the report step;
+    // the solver re-evaluates it over each of its substeps
+    std::vector<double>& perf_polymer_inflow = well_state.perfPolymerInflow();
+    report_step_start_ = timer.simulationTimeElapsed();
+    if (!polymer_inflow_ && deck_->hasKeyword("WPOLYMER")) {
         if (wells_manager.c_wells() == 0) {
             OPM_THROW(std::runtime_error, "Cannot control polymer injection via WPOLYMER without wells.");
         }
-        polymer_inflow_ptr.reset(new PolymerInflowFromDeck(deck_, BaseType::eclipse_state_, *wells, Opm::UgGridHelpers::numCells(BaseType::grid_), timer.currentStepNum()));
+        // The WPOLYMER timeline of the schedule is read once; each report
+        // step only looks up the concentrations of its wells.
+        polymer_inflow_.reset(new PolymerInflowSchedule(BaseType::eclipse_state_));
+    }
+    if (polymer_inflow_ && wells) {
+        polymer_inflow_->getPerfInflowValues(timer.simulationTimeElapsed(),
+                                             timer.simulationTimeElapsed() + timer.currentStepLength(),
+                                             *wells, perf_polymer_inflow);
     } else {
-        polymer_inflow_ptr.reset(new PolymerInflowBasic(0.0*Opm::unit::day,
-                                                        1.0*Opm::unit::day,
-                                                        0.0));
+        const int nperf = wells ? wells->well_connpos[wells->number_of_wells] : 0;
+        perf_polymer_inflow.assign(nperf, 0.0);
     }
-    std::vector<double> polymer_inflow_c(Opm::UgGridHelpers::numCells(BaseType::grid_));
-    polymer_inflow_ptr->getInflowValues(timer.simulationTimeElapsed(),
-                                        timer.simulationTimeElapsed() + timer.currentStepLength(),
-                                        polymer_inflow_c);
-    well_state.polymerInflow() = polymer_inflow_c;
 }
 
 
@@ -25,13 +25,18 @@
 namespace Opm
 {
 
+    /// Well state of the polymer models. In addition to the black-oil
+    /// well state it holds the polymer concentration injected through
+    /// every perforation, ordered as the perforations of the Wells
+    /// struct (the rows of wops_.w2p), zero for producing wells and
+    /// water without polymer.
     class WellStateFullyImplicitBlackoilPolymer : public WellStateFullyImplicitBlackoil
     {
     public:
-        std::vector<double>& polymerInflow() { return polymer_inflow_; }
-        const std::vector<double>& polymerInflow() const { return polymer_inflow_; }
+        std::vector<double>& perfPolymerInflow() { return perf_polymer_inflow_; }
+        const std::vector<double>& perfPolymerInflow() const { return perf_polymer_inflow_; }
     private:
-        std::vector<double> polymer_inflow_;
+        std::vector<double> perf_polymer_inflow_;
     };
 
 } // namespace Opm
@@ -21,10 +21,29 @@
 
 #include <opm/polymer/polymerUtilities.hpp>
 #include <opm/core/utility/miscUtilities.hpp>
+#include <algorithm>
 
 namespace Opm
 {
 
+    namespace
+    {
+        /// Compensated (Kahan) summation.
+        struct KahanSum
+        {
+            KahanSum() : sum(0.0), comp(0.0) {}
+            void add(const double x)
+            {
+                const double y = x - comp;
+                const double t = sum + y;
+                comp = (t - sum) - y;
+                sum = t;
+            }
+            double sum;
+            double comp;
+        };
+    } // anonymous namespace
+
     /// @brief Computes total mobility for a set of s/c values.
     /// @param[in]  props     rock and fluid properties
     /// @param[in]  polyprops polymer properties
@@ -210,9 +229,54 @@ namespace Opm
         if (int(state.saturation().size()) != num_cells*np) {
             OPM_THROW(std::runtime_error, "Sizes of state vectors do not match number of cells.");
         }
-        const std::vector<double>& s = state.saturation();
-        const std::vector<double>& c = state.concentration();
-        const std::vector<double>& cmax = state.maxconcentration();
+        SourceCellsSnapshot snapshot;
+        snapshotSourceCells(state, transport_src, inj_c, dt, snapshot);
+        computeInjectedProduced(props, polyprops, snapshot, injected, produced, polyinj, polyprod);
+    }
+
+
+
+    void snapshotSourceCells(const PolymerState& state,
+                             const std::vector<double>& src,
+                             const std::vector<double>& inj_c,
+                             const double dt,
+                             SourceCellsSnapshot& snapshot)
+    {
+        const int num_cells = src.size();
+        const int np = state.numPhases();
+        snapshot.dt = dt;
+        snapshot.cells.clear();
+        snapshot.src.clear();
+        snapshot.inj_c.clear();
+        snapshot.s.clear();
+        snapshot.c.clear();
+        snapshot.cmax.clear();
+        for (int cell = 0; cell < num_cells; ++cell) {
+            if (src[cell] != 0.0) {
+                snapshot.cells.push_back(cell);
+                snapshot.src.push_back(src[cell]);
+                snapshot.inj_c.push_back(inj_c[cell]);
+                snapshot.s.insert(snapshot.s.end(),
+                                  state.saturation().begin() + np*cell,
+                                  state.saturation().begin() + np*(cell + 1));
+                snapshot.c.push_back(state.concentration()[cell]);
+                snapshot.cmax.push_back(state.maxconcentration()[cell]);
+            }
+        }
+    }
+
+
+
+    void computeInjectedProduced(const IncompPropertiesInterface& props,
+                                 const Opm::PolymerProperties& polyprops,
+                                 const SourceCellsSnapshot& snapshot,
+                                 double* injected,
+                                 double* produced,
+                                 double& polyinj,
+                                 double& polyprod)
+    {
+        const int np = props.numPhases();
+        const double dt = snapshot.dt;
         std::fill(injected, injected + np, 0.0);
         std::fill(produced, produced + np, 0.0);
         polyinj = 0.0;
@@ -221,21 +285,23 @@ namespace Opm
         std::vector<double> kr_cell(np);
         double mob[2];
         double mc;
-        for (int cell = 0; cell < num_cells; ++cell) {
-            if (transport_src[cell] > 0.0) {
-                injected[0] += transport_src[cell]*dt;
-                polyinj += transport_src[cell]*dt*inj_c[cell];
-            } else if (transport_src[cell] < 0.0) {
-                const double flux = -transport_src[cell]*dt;
-                const double* sat = &s[np*cell];
+        const int num_src = snapshot.cells.size();
+        for (int i = 0; i < num_src; ++i) {
+            const int cell = snapshot.cells[i];
+            if (snapshot.src[i] > 0.0) {
+                injected[0] += snapshot.src[i]*dt;
+                polyinj += snapshot.src[i]*dt*snapshot.inj_c[i];
+            } else if (snapshot.src[i] < 0.0) {
+                const double flux = -snapshot.src[i]*dt;
+                const double* sat = &snapshot.s[np*i];
                 props.relperm(1, sat, &cell, &kr_cell[0], 0);
-                polyprops.effectiveMobilities(c[cell], cmax[cell], visc,
+                polyprops.effectiveMobilities(snapshot.c[i], snapshot.cmax[i], visc,
                                               &kr_cell[0], mob);
                 double totmob = mob[0] + mob[1];
                 for (int p = 0; p < np; ++p) {
                     produced[p] += (mob[p]/totmob)*flux;
                 }
-                polyprops.computeMc(c[cell], mc);
+                polyprops.computeMc(snapshot.c[i], mc);
                 polyprod += (mob[0]/totmob)*flux*mc;
             }
         }
@@ -382,6 +448,66 @@ namespace Opm
         return abs_mass;
     }
 
+    /// @brief Computes saturated volumes, free polymer mass and adsorbed
+    /// polymer mass in a single pass over all grid cells.
+    /// @param[in]  props     fluid and rock properties.
+    /// @param[in]  polyprops polymer properties
+    /// @param[in]  pv        the pore volume by cell.
+    /// @param[in]  s         saturation values (for both phases)
+    /// @param[in]  c         polymer concentration
+    /// @param[in]  cmax      max polymer concentration for cell
+    /// @param[out] balance   volumes and masses in place.
+    void computePolymerBalance(const IncompPropertiesInterface& props,
+                               const Opm::PolymerProperties& polyprops,
+                               const std::vector<double>& pv,
+                               const std::vector<double>& s,
+                               const std::vector<double>& c,
+                               const std::vector<double>& cmax,
+                               PolymerBalance& balance)
+    {
+        const int num_cells = pv.size();
+        if (int(s.size()) != 2*num_cells) {
+            OPM_THROW(std::runtime_error, "Sizes of s and pv vectors do not match.");
+        }
+        const double rhor = polyprops.rockDensity();
+        const double* poro = props.porosity();
+        double c_ads_zero;
+        polyprops.simpleAdsorption(0.0, c_ads_zero);
+
+        // Fixed blocks make the summation order independent of threading.
+        const int block_size = 4096;
+        const int num_blocks = (num_cells + block_size - 1)/block_size;
+        std::vector<KahanSum> block_sums(4*num_blocks);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+        for (int block = 0; block < num_blocks; ++block) {
+            KahanSum* sums = &block_sums[4*block];
+            const int end = std::min(num_cells, (block + 1)*block_size);
+            for (int cell = block*block_size; cell < end; ++cell) {
+                const double sw_pv = s[2*cell]*pv[cell];
+                sums[0].add(sw_pv);
+                sums[1].add(s[2*cell + 1]*pv[cell]);
+                sums[2].add(c[cell]*sw_pv);
+                double c_ads = c_ads_zero;
+                if (cmax[cell] != 0.0) {
+                    polyprops.simpleAdsorption(cmax[cell], c_ads);
+                }
+                sums[3].add(c_ads*pv[cell]*((1.0 - poro[cell])/poro[cell])*rhor);
+            }
+        }
+        KahanSum total[4];
+        for (int block = 0; block < num_blocks; ++block) {
+            for (int q = 0; q < 4; ++q) {
+                total[q].add(block_sums[4*block + q].sum);
+            }
+        }
+        balance.satvol[0] = total[0].sum;
+        balance.satvol[1] = total[1].sum;
+        balance.polymass = total[2].sum*(1.0 - polyprops.deadPoreVol());
+        balance.polymass_adsorbed = total[3].sum;
+    }
+
     /// @brief Computes total absorbed polymer mass over all grid cells.
     /// With compressibility
     /// @param[in]  grid      grid
@@ -136,6 +136,52 @@ namespace Opm
                                  double& polyinj,
                                  double& polyprod);
 
+    /// @brief The cells with a nonzero transport source and their state
+    ///        at the end of a transport step: all that the injected and
+    ///        produced volumes depend on. Allows computing them later,
+    ///        e.g. on an output thread, without copying the whole state.
+    struct SourceCellsSnapshot
+    {
+        double dt;                  ///< timestep used
+        std::vector<int> cells;     ///< cells with a nonzero source
+        std::vector<double> src;    ///< transport source of these cells
+        std::vector<double> inj_c;  ///< injected concentration of these cells
+        std::vector<double> s;      ///< saturations, P values per cell
+        std::vector<double> c;      ///< polymer concentration
+        std::vector<double> cmax;   ///< max polymer concentration
+    };
+
+    /// @brief Copies the state of the cells with nonzero transport source.
+    /// @param[in]  state     state variables after the transport step
+    /// @param[in]  src       transport source, as for computeInjectedProduced()
+    /// @param[in]  inj_c     injected concentration by cell
+    /// @param[in]  dt        timestep used
+    /// @param[out] snapshot  the source cells and their state
+    void snapshotSourceCells(const PolymerState& state,
+                             const std::vector<double>& src,
+                             const std::vector<double>& inj_c,
+                             const double dt,
+                             SourceCellsSnapshot& snapshot);
+
+    /// @brief Computes injected and produced volumes of all phases, and
+    ///        injected and produced polymer mass, from a snapshot of the
+    ///        source cells. Gives the same as computeInjectedProduced()
+    ///        with the state the snapshot was taken from.
+    /// @param[in]  props     fluid and rock properties.
+    /// @param[in]  polyprops polymer properties
+    /// @param[in]  snapshot  source cells and their state
+    /// @param[out] injected  must point to a valid array with P elements.
+    /// @param[out] produced  must also point to a valid array with P elements.
+    /// @param[out] polyinj   injected mass of polymer
+    /// @param[out] polyprod  produced mass of polymer
+    void computeInjectedProduced(const IncompPropertiesInterface& props,
+                                 const Opm::PolymerProperties& polyprops,
+                                 const SourceCellsSnapshot& snapshot,
+                                 double* injected,
+                                 double* produced,
+                                 double& polyinj,
+                                 double& polyprod);
+
     /// @brief Computes injected and produced volumes of all phases,
     ///        and injected and produced polymer mass - in the compressible case.
     /// Note 1: assumes that only the first phase is injected.
@@ -187,6 +233,35 @@ namespace Opm
                                   const std::vector<double>& pv,
                                   const std::vector<double>& cmax);
 
+    /// @brief Volumes and polymer mass in place.
+    struct PolymerBalance
+    {
+        double satvol[2];          ///< saturated volume of each phase
+        double polymass;           ///< free polymer mass
+        double polymass_adsorbed;  ///< adsorbed polymer mass
+    };
+
+    /// @brief Computes saturated volumes, free polymer mass and adsorbed
+    /// polymer mass in a single pass over all grid cells. Gives the same
+    /// quantities as computeSaturatedVol(), computePolymerMass() and
+    /// computePolymerAdsorbed(). The sums are compensated (Kahan) within
+    /// fixed blocks of cells and the block sums are added in order, so the
+    /// result does not depend on the number of threads.
+    /// @param[in]  props     fluid and rock properties.
+    /// @param[in]  polyprops polymer properties
+    /// @param[in]  pv        the pore volume by cell.
+    /// @param[in]  s         saturation values (for both phases)
+    /// @param[in]  c         polymer concentration
+    /// @param[in]  cmax      max polymer concentration for cell
+    /// @param[out] balance   volumes and masses in place.
+    void computePolymerBalance(const IncompPropertiesInterface& props,
+                               const Opm::PolymerProperties& polyprops,
+                               const std::vector<double>& pv,
+                               const std::vector<double>& s,
+                               const std::vector<double>& c,
+                               const std::vector<double>& cmax,
+                               PolymerBalance& balance);
+
     /// @brief Computes total absorbed polymer mass over all grid cells.
     /// With compressibility
     /// @param[in]  grid      grid
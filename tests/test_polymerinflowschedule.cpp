@@ -0,0 +1,133 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <config.h>
+
+#if HAVE_DYNAMIC_BOOST_TEST
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#define NVERBOSE  // Suppress own messages when throw()ing
+
+#define BOOST_TEST_MODULE PolymerInflowScheduleTest
+#include <boost/test/unit_test.hpp>
+
+#include <opm/polymer/PolymerInflow.hpp>
+
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+using Opm::PolymerInflowSchedule;
+
+namespace
+{
+    // One well, INJ, with concentration 1 at t = 10, 3 at t = 20 and 2 at t = 40.
+    // Stepwise, the concentration is 0, 1, 3 and 2 on [0, 10), [10, 20),
+    // [20, 40) and [40, inf); linearly, it goes from 1 to 3 over [10, 20]
+    // and from 3 to 2 over [20, 40].
+    PolymerInflowSchedule makeSchedule(const PolymerInflowSchedule::Interpolation interpolation)
+    {
+        PolymerInflowSchedule::Table table;
+        table.push_back(std::make_pair(10.0, 1.0));
+        table.push_back(std::make_pair(20.0, 3.0));
+        table.push_back(std::make_pair(40.0, 2.0));
+        std::unordered_map<std::string, PolymerInflowSchedule::Table> tables;
+        tables["INJ"] = table;
+        return PolymerInflowSchedule(tables, interpolation);
+    }
+
+    const double tol = 1.0e-10; // Percent, for BOOST_CHECK_CLOSE.
+}
+
+
+
+BOOST_AUTO_TEST_CASE(StepwiseAverage)
+{
+    const PolymerInflowSchedule schedule = makeSchedule(PolymerInflowSchedule::Stepwise);
+
+    // Within one interval of the table.
+    BOOST_CHECK_CLOSE(schedule.wellConcentration("INJ", 12.0, 18.0), 1.0, tol);
+    // Across one table point: (5*1 + 10*3) / 15.
+    BOOST_CHECK_CLOSE(schedule.wellConcentration("INJ", 15.0, 30.0), 35.0/15.0, tol);
+    // Across all table points: (10*1 + 20*3 + 20*2) / 60.
+    BOOST_CHECK_CLOSE(schedule.wellConcentration("INJ", 0.0, 60.0), 110.0/60.0, tol);
+    // Starting before the first time: (10*1 + 5*3) / 20.
+    BOOST_CHECK_CLOSE(schedule.wellConcentration("INJ", 5.0, 25.0), 1.25, tol);
+    // Ending after the last time: (10*3 + 10*2) / 20.
+    BOOST_CHECK_CLOSE(schedule.wellConcentration("INJ", 30.0, 50.0), 2.5, tol);
+    // Empty interval: the concentration at its time.
+    BOOST_CHECK_CLOSE(schedule.wellConcentration("INJ", 15.0, 15.0), 1.0, tol);
+}
+
+
+
+BOOST_AUTO_TEST_CASE(LinearAverage)
+{
+    const PolymerInflowSchedule schedule = makeSchedule(PolymerInflowSchedule::Linear);
+
+    // Within one interval of the table, from 1.4 to 2.6.
+    BOOST_CHECK_CLOSE(schedule.wellConcentration("INJ", 12.0, 18.0), 2.0, tol);
+    // Across one table point: (5*2.5 + 10*2.75) / 15.
+    BOOST_CHECK_CLOSE(schedule.wellConcentration("INJ", 15.0, 30.0), 40.0/15.0, tol);
+    // Across all table points: (10*2 + 20*2.5 + 20*2) / 60.
+    BOOST_CHECK_CLOSE(schedule.wellConcentration("INJ", 0.0, 60.0), 110.0/60.0, tol);
+    // Starting before the first time: (10*2 + 5*2.875) / 20.
+    BOOST_CHECK_CLOSE(schedule.wellConcentration("INJ", 5.0, 25.0), 1.71875, tol);
+    // Ending after the last time: (10*2.25 + 10*2) / 20.
+    BOOST_CHECK_CLOSE(schedule.wellConcentration("INJ", 30.0, 50.0), 2.125, tol);
+    // Empty interval: the interpolated concentration at its time.
+    BOOST_CHECK_CLOSE(schedule.wellConcentration("INJ", 15.0, 15.0), 2.0, tol);
+}
+
+
+
+BOOST_AUTO_TEST_CASE(OutsideTable)
+{
+    const PolymerInflowSchedule stepwise = makeSchedule(PolymerInflowSchedule::Stepwise);
+    const PolymerInflowSchedule linear = makeSchedule(PolymerInflowSchedule::Linear);
+
+    // No polymer before the first time.
+    BOOST_CHECK_EQUAL(stepwise.wellConcentration("INJ", 0.0, 5.0), 0.0);
+    BOOST_CHECK_EQUAL(linear.wellConcentration("INJ", 0.0, 5.0), 0.0);
+    BOOST_CHECK_EQUAL(linear.wellConcentration("INJ", 5.0, 5.0), 0.0);
+
+    // The last concentration after the last time.
+    BOOST_CHECK_CLOSE(stepwise.wellConcentration("INJ", 50.0, 60.0), 2.0, tol);
+    BOOST_CHECK_CLOSE(linear.wellConcentration("INJ", 50.0, 60.0), 2.0, tol);
+    BOOST_CHECK_CLOSE(linear.wellConcentration("INJ", 40.0, 40.0), 2.0, tol);
+
+    // No polymer for wells not in the schedule.
+    BOOST_CHECK_EQUAL(stepwise.wellConcentration("PROD", 15.0, 30.0), 0.0);
+}
+
+
+
+BOOST_AUTO_TEST_CASE(SubstepsAddUp)
+{
+    // Substeps of a report step, weighted by their lengths, give the
+    // average of the report step.
+    const PolymerInflowSchedule schedule = makeSchedule(PolymerInflowSchedule::Linear);
+    const double t[] = { 5.0, 11.0, 20.0, 33.0, 47.0 };
+    double weighted = 0.0;
+    for (int k = 0; k < 4; ++k) {
+        weighted += (t[k + 1] - t[k]) * schedule.wellConcentration("INJ", t[k], t[k + 1]);
+    }
+    BOOST_CHECK_CLOSE(weighted / (t[4] - t[0]), schedule.wellConcentration("INJ", t[0], t[4]), tol);
+}